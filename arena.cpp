@@ -0,0 +1,106 @@
+/* Per-process bump arena */
+
+#include <cstdlib>
+#include <cstdint>
+#include "arena.h"
+
+using namespace std;
+
+static const size_t MAX_BLOCK_SIZE = 1 << 20;
+static const size_t MAX_RETAINED_BYTES = 4 << 20;
+
+/* Constructor: no memory is taken until the first allocation. */
+Arena::Arena(size_t firstBlockSize) : current(0), nextBlockSize(firstBlockSize) {}
+
+/* Destructor runs pending finalizers and returns all blocks to the heap. */
+Arena::~Arena() {
+    Reset();
+    for (auto& block : blocks) {
+        free(block.data);
+    }
+}
+
+/* Adds a block big enough for minSize. Block sizes double up to 1 MB so a
+   large program needs only a handful of blocks. */
+void Arena::AddBlock(size_t minSize) {
+    size_t size = nextBlockSize;
+    while (size < minSize) {
+        size *= 2;
+    }
+
+    Block block;
+    block.data = static_cast<char*>(malloc(size));
+    if (block.data == nullptr) {
+        throw bad_alloc();
+    }
+    block.size = size;
+    block.used = 0;
+    blocks.push_back(block);
+    current = blocks.size() - 1;
+
+    if (nextBlockSize < MAX_BLOCK_SIZE) {
+        nextBlockSize *= 2;
+    }
+}
+
+/* Returns size bytes aligned to align. Moves on to the next retained block,
+   or adds a new one, when the current block is full. */
+void* Arena::Allocate(size_t size, size_t align) {
+    while (true) {
+        while (current < blocks.size()) {
+            Block& block = blocks[current];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            uintptr_t aligned = (base + block.used + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+            size_t offset = static_cast<size_t>(aligned - base);
+            if (offset + size <= block.size) {
+                block.used = offset + size;
+                return block.data + offset;
+            }
+            current++;
+        }
+
+        AddBlock(size + align);
+    }
+}
+
+/* Releases every allocation in one go. Destructors registered by New() run in
+   reverse order; blocks are kept (up to 4 MB) so a recycled arena does not
+   go back to the heap. */
+void Arena::Reset() {
+    for (size_t i = finalizers.size(); i > 0; i--) {
+        finalizers[i - 1].destroy(finalizers[i - 1].object);
+    }
+    finalizers.clear();
+
+    size_t retained = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (retained + blocks[i].size <= MAX_RETAINED_BYTES) {
+            retained += blocks[i].size;
+            blocks[i].used = 0;
+            blocks[kept++] = blocks[i];
+        } else {
+            free(blocks[i].data);
+        }
+    }
+    blocks.resize(kept);
+    current = 0;
+}
+
+/* Bytes handed out since the last Reset(). */
+size_t Arena::GetBytesUsed() const {
+    size_t used = 0;
+    for (const auto& block : blocks) {
+        used += block.used;
+    }
+    return used;
+}
+
+/* Bytes held by the arena, used or not. */
+size_t Arena::GetBytesReserved() const {
+    size_t reserved = 0;
+    for (const auto& block : blocks) {
+        reserved += block.size;
+    }
+    return reserved;
+}
@@ -0,0 +1,100 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+using namespace std;
+
+/* Bump allocator owning every allocation of one process. Allocation is a
+   pointer bump inside the current block; nothing is freed individually.
+   Reset() releases everything at once and keeps the blocks for reuse. */
+class Arena {
+private:
+    struct Block {
+        char* data;
+        size_t size;
+        size_t used;
+    };
+
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+    };
+
+    vector<Block> blocks;
+    vector<Finalizer> finalizers;
+    size_t current;
+    size_t nextBlockSize;
+
+    void AddBlock(size_t minSize);
+
+    template<typename T>
+    static void DestroyObject(void* object) { static_cast<T*>(object)->~T(); }
+
+public:
+    explicit Arena(size_t firstBlockSize = 4096);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t align = alignof(max_align_t));
+    void Reset();
+
+    size_t GetBytesUsed() const;
+    size_t GetBytesReserved() const;
+
+    /* Constructs a T inside the arena. Types with a non-trivial destructor
+       are remembered and destroyed by Reset(). */
+    template<typename T, typename... Args>
+    T* New(Args&&... args) {
+        T* object = new (Allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+        if (!is_trivially_destructible<T>::value) {
+            Finalizer finalizer;
+            finalizer.destroy = &Arena::DestroyObject<T>;
+            finalizer.object = object;
+            finalizers.push_back(finalizer);
+        }
+        return object;
+    }
+};
+
+/* STL allocator that takes memory from an Arena, or from the heap when no
+   arena is given. deallocate() is a no-op for arena memory. */
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    Arena* arena;
+
+    ArenaAllocator(Arena* owner = nullptr) noexcept : arena(owner) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        if (arena != nullptr) {
+            return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        if (arena == nullptr) {
+            ::operator delete(p);
+        }
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+#endif
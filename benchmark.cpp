@@ -0,0 +1,411 @@
+/* Microbenchmarks for the scheduler and process hot paths.
+   Built as the separate mo1-bench target; results are written as JSON. */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include "scheduler.h"
+#include "process.h"
+#include "processname.h"
+
+using namespace std;
+
+struct BenchResult {
+    string name;
+    long long iterations;
+    double seconds;
+    double p99Ns;       // 0 unless timed per operation (MeasureTail)
+};
+
+static vector<BenchResult> results;
+static bool quick = false;
+
+/* Times body(iterations) and records the result. The body runs the whole
+   loop itself so the timer overhead is paid once, not per operation. */
+static void Measure(const string& name, long long iterations, const function<void(long long)>& body) {
+    auto start = chrono::steady_clock::now();
+    body(iterations);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    results.push_back({ name, iterations, seconds, 0 });
+
+    cerr << left << setw(40) << name << right << setw(12) << fixed << setprecision(1)
+        << (seconds * 1e9 / iterations) << " ns/op" << endl;
+}
+
+/* Times every call of op separately and records the total and the 99th
+   percentile, for benchmarks where the slow ticks matter more than the mean. */
+static void MeasureTail(const string& name, long long iterations, const function<void()>& op) {
+    vector<double> samples;
+    samples.reserve(iterations);
+    for (long long i = 0; i < iterations; i++) {
+        auto start = chrono::steady_clock::now();
+        op();
+        samples.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+    }
+
+    double seconds = 0;
+    for (double ns : samples) seconds += ns / 1e9;
+    sort(samples.begin(), samples.end());
+    double p99 = samples[min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.99))];
+    results.push_back({ name, iterations, seconds, p99 });
+
+    cerr << left << setw(40) << name << right << setw(12) << fixed << setprecision(1)
+        << (seconds * 1e9 / iterations) << " ns/op" << setw(12) << p99 << " ns p99" << endl;
+}
+
+/* Scheduler settings shared by the benchmarks; the interesting knobs are set per run. */
+static Config MakeConfig(int cores, SchedulerType type) {
+    Config config;
+    config.numCPU = cores;
+    config.type = type;
+    config.quantumCycles = 5;
+    config.batchProcessFreq = 1;
+    config.minIns = 1000;
+    config.maxIns = 2000;
+    config.logSpillDir = "none";
+    config.seed = 12345;    // same workload on every run
+    return config;
+}
+
+/* Scheduler::Tick dispatching and executing a fixed process table of four
+   long processes per core, with generation off so only the tick itself is
+   timed (BenchGenerate covers generation). Run for every scheduling policy. */
+static void BenchTick(int cores, SchedulerType type) {
+    Config config = MakeConfig(cores, type);
+    config.minIns = 20000;
+    config.maxIns = 40000;
+
+    Scheduler scheduler;
+    scheduler.Initialize(config);
+    for (int i = 0; i < 4 * cores; i++) {
+        scheduler.CreateNewProcess(ProcessName::Numbered("bench", i));
+    }
+
+    long long warmup = quick ? 200 : 1000;
+    for (long long i = 0; i < warmup; i++) {
+        scheduler.Tick();
+    }
+
+    string name = string("tick/") + SchedulingPolicy::GetKey(type) + "/cores=" + to_string(cores);
+    Measure(name, quick ? 1000 : 5000, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            scheduler.Tick();
+        }
+    });
+}
+
+/* Scheduler::Tick at 64 cores with a fixed process table and generation
+   off, with the execute phase on worker-threads host threads (0 = inline).
+   Shows whether the per-tick barrier pays for itself. */
+static void BenchWorkers(int threads) {
+    const int cores = 64;
+    Config config = MakeConfig(cores, FCFS);
+    config.minIns = 20000;
+    config.maxIns = 40000;
+    config.workerThreads = threads;
+
+    Scheduler scheduler;
+    scheduler.Initialize(config);
+    for (int i = 0; i < 4 * cores; i++) {
+        scheduler.CreateNewProcess(ProcessName::Numbered("bench", i));
+    }
+
+    Measure("tick-workers/cores=64/threads=" + to_string(threads), quick ? 2000 : 20000, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            scheduler.Tick();
+        }
+    });
+}
+
+/* Scheduler::CreateNewProcess, including program generation. */
+static void BenchCreateProcess() {
+    Scheduler scheduler;
+    scheduler.Initialize(MakeConfig(4, ROUND_ROBIN));
+
+    Measure("create-process", quick ? 2000 : 20000, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            scheduler.CreateNewProcess(ProcessName::Numbered("bench", i));
+        }
+    });
+}
+
+/* Scheduler::Tick with long programs generated in batches, built inside the
+   tick (threads=0) or by the producer threads ahead of it. */
+static void BenchGenerate(int threads) {
+    Config config = MakeConfig(8, ROUND_ROBIN);
+    config.minIns = 20000;
+    config.maxIns = 40000;
+    config.batchProcessFreq = 10;
+    config.batchSize = 4;
+    config.generatorThreads = threads;
+    config.retireAfter = 100;
+
+    Scheduler scheduler;
+    scheduler.Initialize(config);
+    scheduler.Start();
+
+    Measure("tick-generate/threads=" + to_string(threads), quick ? 200 : 2000, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            scheduler.Tick();
+        }
+    });
+}
+
+/* Per-tick latency with a batch generated on every tick, as process length
+   (max-ins, min-ins half of it) and batch-size grow, ticking the way the
+   interactive console does. With producer threads the tick only links in
+   what is built and defers the rest, so its p99 should stay flat; inline
+   generation grows with both. The other benchmarks wait for the producers
+   and keep arrivals exact. */
+static void BenchGenerateTail(int threads, int maxIns, int batchSize) {
+    Config config = MakeConfig(8, ROUND_ROBIN);
+    config.minIns = maxIns / 2;
+    config.maxIns = maxIns;
+    config.batchProcessFreq = 1;
+    config.batchSize = batchSize;
+    config.generatorThreads = threads;
+    config.retireAfter = 100;
+
+    Scheduler scheduler;
+    scheduler.Initialize(config);
+    scheduler.SetDeferGeneration(true);
+    scheduler.Start();
+    for (int i = 0; i < 20; i++) {
+        scheduler.Tick();
+    }
+
+    string name = "tick-generate-tail/threads=" + to_string(threads) + "/max-ins=" + to_string(maxIns) +
+        "/batch=" + to_string(batchSize);
+    MeasureTail(name, quick ? 150 : 400, [&]() { scheduler.Tick(); });
+}
+
+/* Simulated ticks of a fixed set of long processes, run the way the
+   headless loop runs them: idle ticks skipped and, when sliced, quiet
+   stretches run with Scheduler::RunSlice() instead of one Tick() each. */
+static void BenchSlice(int cores, SchedulerType type, bool sliced) {
+    Config config = MakeConfig(cores, type);
+    config.delaysPerExec = 4;
+    config.minIns = 20000;
+    config.maxIns = 40000;
+
+    Scheduler scheduler;
+    scheduler.Initialize(config);
+    for (int i = 0; i < 2 * cores; i++) {
+        scheduler.CreateNewProcess(ProcessName::Numbered("bench", i));
+    }
+
+    string name = string("run/") + SchedulingPolicy::GetKey(type) + "/cores=" + to_string(cores) + (sliced ? "/sliced" : "/ticked");
+    Measure(name, quick ? 20000 : 200000, [&](long long n) {
+        long long done = 0;
+        while (done < n) {
+            long long idle = scheduler.CountIdleTicks();
+            if (idle != 0) {
+                long long jump = (idle < 0) ? n - done : min(idle, n - done);
+                scheduler.SkipTicks(jump);
+                done += jump;
+                continue;
+            }
+            int ran = sliced ? scheduler.RunSlice(static_cast<int>(n - done)) : 0;
+            if (ran == 0) {
+                scheduler.Tick();
+                ran = 1;
+            }
+            done += ran;
+        }
+    });
+}
+
+/* Process::Execute on a program made only of the given op. */
+static void BenchExecute(const string& name, ExecBackend backend, const vector<Op>& ops, const vector<Op>& loopBodies) {
+    ProgramOptions options;
+    options.backend = backend;
+    Process process(ProcessName::Numbered("bench", 1), 1, 0, 0, options);
+
+    long long rounds = quick ? 4 : 32;
+    Measure(string("execute/") + (backend == BACKEND_BYTECODE ? "bytecode/" : "objects/") + name,
+        rounds * static_cast<long long>(ops.size()), [&](long long) {
+        for (long long r = 0; r < rounds; r++) {
+            process.LoadProgram(ops, loopBodies);
+            for (size_t i = 0; i < ops.size(); i++) {
+                process.Execute(0);
+                if (process.GetState() == WAITING) {
+                    // Skip the sleep itself; only the instruction is measured
+                    process.SetWaitCycles(0);
+                    process.SetState(RUNNING);
+                }
+            }
+        }
+    });
+}
+
+/* Builds one single-type program per instruction and runs it on both backends.
+   The FOR case goes through ForLoopInstruction on the object backend. A
+   generated program is run as generated and after Program::Optimize(). */
+static void BenchInstructions() {
+    const size_t lines = 4096;
+    uint32_t message = MessageTable::Intern("Hello world from {}!");
+    vector<Op> noBodies;
+
+    vector<pair<string, Op>> singles = {
+        { "print", MakeOp(OP_PRINT, 0, 0, message) },
+        { "declare", MakeOp(OP_DECLARE, 1, 0, 42) },
+        { "add", MakeOp(OP_ADD, 1, 2, 7) },
+        { "subtract", MakeOp(OP_SUBTRACT, 1, 2, 7) },
+        { "sleep", MakeOp(OP_SLEEP, 0, 0, 1) },
+    };
+
+    vector<Op> loopBodies(3, MakeOp(OP_PRINT, 0, 0, message));
+    vector<Op> forOps(lines, MakeOp(OP_FOR, 3, 4, 0));
+
+    Program generated;
+    ProgramGenerator generator;
+    generator.Start(12345, generated);
+    for (size_t i = 0; i < lines; i++) {
+        generated.ops.push_back(generator.Next(generated));
+    }
+    vector<Op> mixedOps(generated.ops.begin(), generated.ops.end());
+    vector<Op> mixedBodies(generated.loopBodies.begin(), generated.loopBodies.end());
+    generated.Optimize();
+    vector<Op> optimizedOps(generated.ops.begin(), generated.ops.end());
+    vector<Op> optimizedBodies(generated.loopBodies.begin(), generated.loopBodies.end());
+
+    for (ExecBackend backend : { BACKEND_BYTECODE, BACKEND_OBJECTS }) {
+        for (const auto& single : singles) {
+            BenchExecute(single.first, backend, vector<Op>(lines, single.second), noBodies);
+        }
+        BenchExecute("for", backend, forOps, loopBodies);
+        BenchExecute("generated", backend, mixedOps, mixedBodies);
+        BenchExecute("generated-optimized", backend, optimizedOps, optimizedBodies);
+    }
+}
+
+/* Scheduler::GetProcess and GetProcessByPID with a large process table. */
+static void BenchLookup(int count) {
+    Scheduler scheduler;
+    Config config = MakeConfig(4, ROUND_ROBIN);
+    config.minIns = 1;
+    config.maxIns = 1;
+    scheduler.Initialize(config);
+
+    for (int i = 0; i < count; i++) {
+        scheduler.CreateNewProcess(ProcessName::Numbered("process", i));
+    }
+
+    Random picks(12345);
+    vector<string> names;
+    for (int i = 0; i < 1024; i++) {
+        names.push_back("process" + to_string(picks.NextInt(count)));
+    }
+
+    long long found = 0;
+    Measure("get-process/n=" + to_string(count), quick ? 20000 : 200000, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            found += scheduler.GetProcess(names[i & 1023]) != nullptr;
+        }
+    });
+    Measure("get-process-by-pid/n=" + to_string(count), quick ? 20000 : 200000, [&](long long n) {
+        for (long long i = 0; i < n; i++) {
+            found += scheduler.GetProcessByPID(1 + static_cast<int>(i % count)) != nullptr;
+        }
+    });
+
+    if (found == 0) {
+        cerr << "lookup benchmark found nothing" << endl;
+    }
+}
+
+/* Writes every result as one JSON document. */
+static void WriteJson(ostream& out) {
+    out << "{\n  \"suite\": \"mo1-bench\",\n  \"quick\": " << (quick ? "true" : "false")
+        << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        double nsPerOp = r.seconds * 1e9 / r.iterations;
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"seconds\": " << setprecision(6) << r.seconds
+            << ", \"ns_per_op\": " << setprecision(2) << nsPerOp
+            << ", \"ops_per_sec\": " << setprecision(0) << (r.seconds > 0 ? r.iterations / r.seconds : 0.0);
+        if (r.p99Ns > 0) {
+            out << ", \"p99_ns\": " << setprecision(2) << r.p99Ns;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+/* Usage: mo1-bench [--quick] [--out file.json]. JSON goes to stdout unless
+   --out is given; the readable summary always goes to stderr. */
+int main(int argc, char* argv[]) {
+    string outFile;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--quick") quick = true;
+        else if (arg == "--out" && i + 1 < argc) outFile = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [--quick] [--out file.json]" << endl;
+            return 1;
+        }
+    }
+
+    cout << fixed;
+
+    // The scheduler prints its settings on Initialize(); keep that out of the JSON
+    ostringstream discard;
+    streambuf* console = cout.rdbuf(discard.rdbuf());
+
+    for (SchedulerType type : { FCFS, ROUND_ROBIN, SJF, SRTF, PRIORITY, MLFQ }) {
+        for (int cores : { 1, 4, 16, 64 }) {
+            BenchTick(cores, type);
+            discard.str("");
+        }
+    }
+    for (int threads : { 0, 2, 4, 8 }) {
+        BenchWorkers(threads);
+        discard.str("");
+    }
+    BenchCreateProcess();
+    for (int threads : { 0, 1, 2 }) {
+        BenchGenerate(threads);
+        discard.str("");
+    }
+    for (int threads : { 0, 2 }) {
+        for (int maxIns : { 1000, 8000, 32000 }) {
+            for (int batchSize : { 1, 4, 8 }) {
+                BenchGenerateTail(threads, maxIns, batchSize);
+                discard.str("");
+            }
+        }
+    }
+    for (SchedulerType type : { FCFS, ROUND_ROBIN }) {
+        for (int cores : { 1, 4 }) {
+            for (bool sliced : { false, true }) {
+                BenchSlice(cores, type, sliced);
+                discard.str("");
+            }
+        }
+    }
+    BenchInstructions();
+    BenchLookup(quick ? 10000 : 100000);
+
+    cout.rdbuf(console);
+
+    if (outFile.empty()) {
+        WriteJson(cout);
+    } else {
+        ofstream file(outFile);
+        if (!file.is_open()) {
+            cerr << "Error: Could not create " << outFile << endl;
+            return 1;
+        }
+        file << fixed;
+        WriteJson(file);
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+/* Compact bytecode representation of generated programs */
+
+#include <algorithm>
+#include "bytecode.h"
+
+using namespace std;
+
+/* Builds an encoded op. Unused fields are left zero. */
+Op MakeOp(OpCode code, uint8_t a, uint8_t b, uint32_t imm) {
+    Op op;
+    op.code = code;
+    op.a = a;
+    op.b = b;
+    op.c = 0;
+    op.imm = imm;
+    return op;
+}
+
+/* Constructor: op arrays allocate from the arena, or the heap when it is null. */
+Program::Program(Arena* arena) : ops(ArenaAllocator<Op>(arena)), loopBodies(ArenaAllocator<Op>(arena)) {}
+
+/* Returns the slot of a variable name, adding it on first use.
+   Resolved once at generation time so execution never compares names. */
+uint8_t Program::ResolveSymbol(const string& name) {
+    for (size_t i = 0; i < symbols.size(); i++) {
+        if (symbols[i] == name) return static_cast<uint8_t>(i);
+    }
+    symbols.push_back(name);
+    return static_cast<uint8_t>(symbols.size() - 1);
+}
+
+/* Rewrites the ops into cheaper ones with the same effect, line for line, so
+   every line still retires on its own tick and line counts do not change.
+   A FOR line retires after one body op (its counters are reset when the
+   line retires), so it is replaced by that op; the loop bodies are dropped
+   once no FOR is left. ADD and SUBTRACT whose operand holds a constant set
+   by an earlier line are folded into a DECLARE of the result, and chains of
+   them fold in turn. Values set before the first op count as unknown, so a
+   lazy window can be optimized on its own. */
+void Program::Optimize() {
+    static const int NO_VALUE = -1;
+    vector<int> known(symbols.size(), NO_VALUE);
+    bool loopsLeft = false;
+
+    for (auto& op : ops) {
+        while (op.code == OP_FOR && op.a > 0 && op.b > 0) {
+            op = loopBodies[op.imm];
+        }
+
+        switch (op.code) {
+        case OP_DECLARE:
+            known[op.a] = static_cast<int>(op.imm);
+            break;
+
+        case OP_ADD:
+        case OP_SUBTRACT: {
+            if (known[op.b] == NO_VALUE) {
+                known[op.a] = NO_VALUE;
+                break;
+            }
+            // Same saturation as Process::ExecuteOp()
+            int result = (op.code == OP_ADD) ? known[op.b] + static_cast<int>(op.imm)
+                                             : known[op.b] - static_cast<int>(op.imm);
+            result = max(0, min(result, static_cast<int>(UINT16_MAX)));
+            op = MakeOp(OP_DECLARE, op.a, 0, static_cast<uint32_t>(result));
+            known[op.a] = result;
+            break;
+        }
+
+        case OP_FOR:
+            loopsLeft = true;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (!loopsLeft) {
+        loopBodies.clear();
+    }
+}
+
+/* Constructor: an unseeded generator; call Start() before Next(). */
+ProgramGenerator::ProgramGenerator() : helloMessage(0) {}
+
+/* Seeds the generator and sets up the symbols and message every generated
+   program uses. var0..var9 get slots 0..9 up front so lazily generated
+   windows never add symbols. The hello message is one shared template;
+   the process name is filled in only when the log is viewed. */
+void ProgramGenerator::Start(uint64_t seed, Program& program) {
+    rng.Seed(seed);
+
+    for (int i = 0; i < 10; i++) {
+        program.ResolveSymbol("var" + to_string(i));
+    }
+    helloMessage = MessageTable::Intern("Hello world from {}!");
+}
+
+/* Emits the next line of the program. FOR bodies are appended to
+   program.loopBodies and referenced by offset. */
+Op ProgramGenerator::Next(Program& program) {
+    int processInstruction = rng.NextInt(6);
+
+    if (processInstruction == 0) {
+        // PRINT instruction
+        return MakeOp(OP_PRINT, 0, 0, helloMessage);
+    }
+    else if (processInstruction == 1) {
+        // DECLARE instruction
+        uint8_t var = static_cast<uint8_t>(rng.NextInt(10));
+        uint16_t value = rng.NextInt(1000);
+        return MakeOp(OP_DECLARE, var, 0, value);
+    }
+    else if (processInstruction == 2) {
+        // ADD instruction
+        uint8_t var1 = static_cast<uint8_t>(rng.NextInt(10));
+        uint8_t var2 = static_cast<uint8_t>(rng.NextInt(10));
+        uint16_t value = rng.NextInt(100);
+        return MakeOp(OP_ADD, var1, var2, value);
+    }
+    else if (processInstruction == 3) {
+        // SUBTRACT instruction
+        uint8_t var1 = static_cast<uint8_t>(rng.NextInt(10));
+        uint8_t var2 = static_cast<uint8_t>(rng.NextInt(10));
+        uint16_t value = rng.NextInt(100);
+        return MakeOp(OP_SUBTRACT, var1, var2, value);
+    }
+    else if (processInstruction == 4) {
+        // SLEEP instruction
+        uint8_t cycles = rng.NextInt(5) + 1;
+        return MakeOp(OP_SLEEP, 0, 0, cycles);
+    }
+
+    // FOR loop instruction
+    int loopRepeats = rng.NextInt(3) + 2;
+    int loopInstructions = rng.NextInt(3) + 1;
+    uint32_t bodyOffset = static_cast<uint32_t>(program.loopBodies.size());
+
+    for (int j = 0; j < loopInstructions; j++) {
+        program.loopBodies.push_back(MakeOp(OP_PRINT, 0, 0, helloMessage));
+    }
+
+    return MakeOp(OP_FOR, static_cast<uint8_t>(loopInstructions), static_cast<uint8_t>(loopRepeats), bodyOffset);
+}
@@ -0,0 +1,76 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "arena.h"
+#include "random.h"
+#include "outputlog.h"
+
+using namespace std;
+
+enum OpCode : uint8_t {
+    OP_PRINT,
+    OP_DECLARE,
+    OP_ADD,
+    OP_SUBTRACT,
+    OP_SLEEP,
+    OP_FOR
+};
+
+/* One encoded instruction, fixed at 8 bytes so a whole program is one
+   contiguous array.
+     PRINT     imm = MessageTable id
+     DECLARE   a = variable slot, imm = value
+     ADD/SUB   a = result slot, b = operand slot, imm = constant operand
+     SLEEP     imm = cycles
+     FOR       a = body length, b = repeats, imm = offset into loopBodies */
+struct Op {
+    uint8_t code;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    uint32_t imm;
+};
+
+static_assert(sizeof(Op) == 8, "Op must stay 8 bytes");
+
+Op MakeOp(OpCode code, uint8_t a, uint8_t b, uint32_t imm);
+
+typedef vector<Op, ArenaAllocator<Op>> OpList;
+
+/* Bytecode form of a generated program: one Op per line of code, FOR bodies
+   stored separately, and the variable names the ops refer to. Message texts
+   live in the global MessageTable so they are shared by every process.
+   The op arrays live in the owning process's arena when one is given. */
+struct Program {
+    OpList ops;
+    OpList loopBodies;
+    vector<string> symbols;
+
+    explicit Program(Arena* arena = nullptr);
+
+    uint8_t ResolveSymbol(const string& name);
+    void Optimize();
+};
+
+/* Produces a random program one line at a time from a seed. The same seed
+   always gives the same program, whether it is generated all at once or
+   window by window as the process runs. */
+class ProgramGenerator {
+private:
+    Random rng;
+    uint32_t helloMessage;
+
+public:
+    ProgramGenerator();
+
+    void Start(uint64_t seed, Program& program);
+    Op Next(Program& program);
+
+    uint64_t GetState() const { return rng.GetState(); }
+    void SetState(uint64_t state) { rng.SetState(state); }
+};
+
+#endif
@@ -0,0 +1,209 @@
+/* Checkpoint file writer and memory-mapped reader */
+
+#include <cstdio>
+#include <cstring>
+#include "checkpoint.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+/* ---------- CheckpointWriter ---------- */
+
+/* Constructor: nothing is opened until Open(). */
+CheckpointWriter::CheckpointWriter() : offset(0) {}
+
+/* Starts a checkpoint in a temporary file next to fileName and reserves
+   room for the header. */
+bool CheckpointWriter::Open(const string& fileName) {
+    path = fileName;
+    tempPath = fileName + ".tmp";
+    file.open(tempPath, ios::binary | ios::trunc);
+    if (!file.is_open()) return false;
+
+    CheckpointHeader blank;
+    memset(&blank, 0, sizeof(blank));
+    file.write(reinterpret_cast<const char*>(&blank), sizeof(blank));
+    offset = sizeof(blank);
+    return file.good();
+}
+
+/* Pads to an 8-byte boundary and returns the offset the next section starts at. */
+uint64_t CheckpointWriter::BeginSection() {
+    static const char zeros[8] = {};
+    uint64_t padding = (8 - offset % 8) % 8;
+    if (padding > 0) {
+        file.write(zeros, static_cast<streamsize>(padding));
+        offset += padding;
+    }
+    return offset;
+}
+
+/* Appends raw bytes to the current section. */
+void CheckpointWriter::Append(const void* data, uint64_t bytes) {
+    if (bytes == 0) return;
+    file.write(static_cast<const char*>(data), static_cast<streamsize>(bytes));
+    offset += bytes;
+}
+
+/* Writes one whole section and returns where it went. */
+CheckpointSection CheckpointWriter::Write(const void* data, uint64_t bytes, uint64_t count) {
+    CheckpointSection section;
+    section.offset = BeginSection();
+    section.count = count;
+    Append(data, bytes);
+    return section;
+}
+
+/* Fills in the fixed header fields, writes the header and moves the finished
+   file into place. Returns false if any write failed. */
+bool CheckpointWriter::Finish(CheckpointHeader& header) {
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.endian = CHECKPOINT_ENDIAN;
+    header.fileSize = offset;
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if (file.fail()) {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    remove(path.c_str());
+    return rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+/* Discards a partly written checkpoint. */
+void CheckpointWriter::Abort() {
+    if (file.is_open()) {
+        file.close();
+    }
+    remove(tempPath.c_str());
+}
+
+/* ---------- CheckpointReader ---------- */
+
+/* Constructor: no file open. */
+CheckpointReader::CheckpointReader() : data(nullptr), size(0), mapped(false) {
+#ifdef _WIN32
+    file = nullptr;
+    mapping = nullptr;
+#else
+    file = -1;
+#endif
+}
+
+/* Destructor unmaps the file. */
+CheckpointReader::~CheckpointReader() {
+    Close();
+}
+
+/* Maps the file and validates the header: magic, version, byte order and size. */
+bool CheckpointReader::Open(const string& fileName, string& error) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "cannot open " + fileName;
+        return false;
+    }
+    LARGE_INTEGER length;
+    GetFileSizeEx(handle, &length);
+    size = static_cast<uint64_t>(length.QuadPart);
+    file = handle;
+
+    if (size > 0) {
+        mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != nullptr) {
+            data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            mapped = data != nullptr;
+        }
+    }
+#else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + fileName;
+        return false;
+    }
+    struct stat info;
+    fstat(fd, &info);
+    size = static_cast<uint64_t>(info.st_size);
+    file = fd;
+
+    if (size > 0) {
+        void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            data = static_cast<const char*>(view);
+            mapped = true;
+        }
+    }
+#endif
+
+    // Fall back to reading the whole file when it cannot be mapped
+    if (!mapped && size > 0) {
+        ifstream in(fileName, ios::binary);
+        buffer.resize(static_cast<size_t>(size));
+        if (!in.read(buffer.data(), static_cast<streamsize>(size))) {
+            error = "cannot read " + fileName;
+            Close();
+            return false;
+        }
+        data = buffer.data();
+    }
+
+    const CheckpointHeader* header = GetHeader();
+    if (size < sizeof(CheckpointHeader) || memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0) {
+        error = fileName + " is not a checkpoint file";
+    }
+    else if (header->version != CHECKPOINT_VERSION) {
+        error = "unsupported checkpoint version " + to_string(header->version);
+    }
+    else if (header->endian != CHECKPOINT_ENDIAN) {
+        error = "checkpoint was written on a machine with a different byte order";
+    }
+    else if (header->fileSize != size) {
+        error = "checkpoint is truncated";
+    }
+    else {
+        return true;
+    }
+
+    Close();
+    return false;
+}
+
+/* Releases the mapping (or buffer) and the file. */
+void CheckpointReader::Close() {
+#ifdef _WIN32
+    if (mapped) UnmapViewOfFile(data);
+    if (mapping != nullptr) CloseHandle(static_cast<HANDLE>(mapping));
+    if (file != nullptr) CloseHandle(static_cast<HANDLE>(file));
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (mapped) munmap(const_cast<char*>(data), size);
+    if (file >= 0) close(file);
+    file = -1;
+#endif
+    buffer.clear();
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
+
+/* Returns length bytes at offset, or nullptr if they fall outside the file. */
+const char* CheckpointReader::GetBytes(uint64_t offset, uint64_t length) const {
+    if (data == nullptr || offset > size || length > size - offset) return nullptr;
+    return data + offset;
+}
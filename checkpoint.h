@@ -0,0 +1,213 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+using namespace std;
+
+/* Binary checkpoint layout (version 8). The file is a header followed by
+   flat arrays of fixed-size records, so loading is a map plus a few
+   fix-ups instead of parsing:
+
+     header      CheckpointHeader
+     messages    [uint32 length][bytes] per MessageTable template
+     names       process name bytes, referenced by ProcessRecord
+     processes   ProcessRecord per live process, in creation order
+     ops         Op arrays, each process's ops followed by its loop bodies
+     variables   uint16 values, varCount per process
+     events      LogEvent arrays, oldest first per process
+     queues      QueueRecord per ready process, in the order it would run
+     cores       int32 pid per core, -1 when idle
+     sleepers    SleepRecord per process in the timing wheel
+     retired     RetiredRecord per retired process, in retirement order
+     coreHistory uint16 core ids, referenced by both record types
+     orders      OrderRecord per generated process not built yet
+     states      int32 pid per live process, in state list order (ready,
+                 running, waiting, finished), so listings keep their order
+
+   Message ids are only stable within one run, so ops and events keep the
+   ids of the saving run and are remapped through the saved message table. */
+
+static const char CHECKPOINT_MAGIC[8] = { 'M', 'O', '1', 'C', 'K', 'P', 'T', 0 };
+static const uint32_t CHECKPOINT_VERSION = 8;
+static const uint32_t CHECKPOINT_ENDIAN = 0x01020304;
+
+struct CheckpointSection {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t fileSize;
+
+    int64_t cpuTicks;
+    int64_t processCounter;
+    int64_t currentPID;
+    int32_t numCPU;
+    int32_t isRunning;
+    uint64_t seed;                  // master seed, so orders made after a restore match
+    int32_t pushCursor;             // per-core queue the next new process goes to
+    int32_t generationDue;          // leading orders already due, waiting on a producer
+
+    CheckpointSection messages;     // count = templates, offset to [len][bytes] list
+    CheckpointSection names;        // count = bytes
+    CheckpointSection processes;
+    CheckpointSection ops;
+    CheckpointSection variables;
+    CheckpointSection events;
+    CheckpointSection queues;
+    CheckpointSection cores;
+    CheckpointSection sleepers;
+    CheckpointSection retired;
+    CheckpointSection coreHistory;
+    CheckpointSection orders;
+    CheckpointSection states;
+};
+
+struct ProcessRecord {
+    uint64_t seed;
+    uint64_t generatorState;
+    int64_t finishTime;
+    uint64_t nameOffset;
+    uint64_t opIndex;
+    uint64_t varIndex;
+    uint64_t eventIndex;
+    uint64_t eventCount;
+    uint64_t coreIndex;
+
+    uint32_t nameLength;
+    uint32_t coreCount;
+    uint32_t opCount;
+    uint32_t bodyCount;
+    uint32_t varCount;
+    uint32_t declaredMask;
+
+    int32_t pid;
+    int32_t state;
+    int32_t backend;
+    int32_t currentLine;
+    int32_t totalLines;
+    int32_t windowStart;
+    int32_t lazyWindow;
+    int32_t loopIteration;
+    int32_t loopIndex;
+    int32_t coreAssigned;
+    int32_t waitCycles;
+    int32_t executionTime;
+    int32_t delayCounter;
+    int32_t quantumCounter;
+    int32_t priority;
+    int32_t policyLevel;
+    int32_t finishTick;
+    int32_t levelEpoch;
+};
+
+/* A retired process; its log events are stored in the events section like
+   those of live processes. */
+struct RetiredRecord {
+    int64_t finishTime;
+    uint64_t nameOffset;
+    uint64_t eventIndex;
+    uint64_t eventCount;
+    uint64_t droppedCount;
+    uint64_t coreIndex;
+
+    uint32_t nameLength;
+    uint32_t coreCount;
+    int32_t pid;
+    int32_t totalLines;
+};
+
+/* A generated process whose number, PID and length were already drawn
+   (see Scheduler::OrderProcesses()). */
+struct OrderRecord {
+    int64_t sequence;
+    int32_t pid;
+    int32_t numInstructions;
+    int32_t priority;
+    int32_t padding;
+};
+
+struct QueueRecord {
+    int32_t queue;
+    int32_t pid;
+};
+
+struct SleepRecord {
+    int32_t pid;
+    int32_t padding;
+    uint64_t wakeTick;
+};
+
+static_assert(sizeof(ProcessRecord) % 8 == 0, "ProcessRecord must keep 8-byte alignment");
+static_assert(sizeof(RetiredRecord) % 8 == 0, "RetiredRecord must keep 8-byte alignment");
+
+/* Writes a checkpoint section by section. Sections are 8-byte aligned so the
+   loader can use the mapped records in place. Large sections can be streamed
+   with BeginSection()/Append(). The header is written last, and the file is
+   renamed into place only when complete. */
+class CheckpointWriter {
+private:
+    string path;
+    string tempPath;
+    ofstream file;
+    uint64_t offset;
+
+public:
+    CheckpointWriter();
+
+    bool Open(const string& fileName);
+    uint64_t BeginSection();
+    void Append(const void* data, uint64_t bytes);
+    CheckpointSection Write(const void* data, uint64_t bytes, uint64_t count);
+    bool Finish(CheckpointHeader& header);
+    void Abort();
+
+    template <typename T>
+    CheckpointSection WriteArray(const vector<T>& items) {
+        return Write(items.data(), items.size() * sizeof(T), items.size());
+    }
+};
+
+/* Read-only view of a checkpoint file, memory-mapped where the platform
+   allows. Section() checks bounds before handing out a typed pointer. */
+class CheckpointReader {
+private:
+    const char* data;
+    uint64_t size;
+    bool mapped;
+    vector<char> buffer;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#else
+    int file;
+#endif
+
+public:
+    CheckpointReader();
+    ~CheckpointReader();
+
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    bool Open(const string& fileName, string& error);
+    void Close();
+
+    const CheckpointHeader* GetHeader() const { return reinterpret_cast<const CheckpointHeader*>(data); }
+    const char* GetBytes(uint64_t offset, uint64_t length) const;
+
+    template <typename T>
+    const T* Section(const CheckpointSection& section) const {
+        if (section.count > size / sizeof(T)) return nullptr;
+        return reinterpret_cast<const T*>(GetBytes(section.offset, section.count * sizeof(T)));
+    }
+};
+
+#endif
@@ -1,14 +1,17 @@
 /* CLI interface + I/O commands */
 
 #include <iostream>
-#include <fstream>
 #include <iomanip>
 #include <chrono>
 #include <thread>
 #include <ctime>
-#include <windows.h>
+#include <future>
+#include <algorithm>
+#include <climits>
+#include "platform.h"
 #include "console.h"
 #include "scheduler.h"
+#include "simclock.h"
 
 using namespace std;
 
@@ -21,6 +24,7 @@ Console::Console() : initialized(false), tickThread(nullptr), shouldRunTicks(fal
 Console::~Console() {
     if (tickThread != nullptr) {
         shouldRunTicks = false;
+        scheduler.Wake();
         if (tickThread->joinable()) {
             tickThread->join();
         }
@@ -34,66 +38,160 @@ void Console::Initialize() {
     scheduler.Initialize("config.txt");
     initialized = true;
 
+    // Catch up at most one second of missed ticks
+    double rate = scheduler.GetTickRate();
+    pacer.Configure(rate, max(1LL, static_cast<long long>(rate)));
+
     shouldRunTicks = true;
     tickThread = new thread(&Console::TickLoop, this);
 
     //cout << "Console initialized successfully." << endl;
 }
 
-/* Simulates the CPU ticking mechanism in real-time.
-   Continuously calls Scheduler::Tick() to update process states. */
+/* Simulates the CPU ticking mechanism in real-time at tick-rate ticks per
+   second. The pacer wakes the thread on fixed deadlines and, after a slow
+   tick, returns several due ticks so the loop catches up instead of drifting.
+   Ticks in which nothing can happen are not run: the thread sleeps until the
+   next event's deadline, or until a command arrives when nothing is pending,
+   and the clock jumps over them. While waiting for a deadline the thread
+   serves console commands as they arrive. A catch-up batch runs as slices
+   where it can (see Scheduler::RunSlice()); commands still run between them. */
 void Console::TickLoop() {
+    // A producer that falls behind delays an arrival rather than the tick
+    scheduler.SetDeferGeneration(true);
+    pacer.Begin();
     while (shouldRunTicks) {
-        scheduler.Tick();
-        this_thread::sleep_for(chrono::milliseconds(100)); // ms per tick, idk if correct tho
+        long long idle = scheduler.CountIdleTicks();
+        if (idle != 0) {
+            if (idle < 0) {
+                scheduler.WaitForCommand();
+            } else if (pacer.IsPaced()) {
+                scheduler.WaitForCommand(pacer.GetDeadline(idle));
+            }
+            scheduler.SkipTicks(pacer.SkipIdle(idle));
+            continue;
+        }
+
+        if (!pacer.IsDue()) {
+            scheduler.WaitForCommand(pacer.GetDeadline(0));
+            scheduler.ServeCommands();
+            continue;
+        }
+
+        int due = pacer.Next();
+        while (due > 0) {
+            int ran = scheduler.IsSliced() ? scheduler.RunSlice(due) : 0;
+            if (ran == 0) {
+                scheduler.Tick();
+                ran = 1;
+            }
+            pacer.Ticked(ran);
+            due -= ran;
+        }
+    }
+    pacer.End();
+    scheduler.SetDeferGeneration(false);
+}
+
+/* Stops the tick thread and waits for the tick in progress to finish, so the
+   scheduler can be read or replaced as a whole. */
+void Console::PauseTicks() {
+    if (tickThread == nullptr) return;
+
+    shouldRunTicks = false;
+    scheduler.Wake();
+    if (tickThread->joinable()) {
+        tickThread->join();
     }
+    delete tickThread;
+    tickThread = nullptr;
 }
 
-/* Utility to format timestamps consistently. */
-static string FormatTimestamp(time_t t) {
-    char buf[64];
-    tm local_tm;
-    localtime_s(&local_tm, &t);
-    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S %p", &local_tm);
-    return string(buf);
+/* Restarts the tick thread after PauseTicks(). */
+void Console::ResumeTicks() {
+    if (tickThread != nullptr) return;
+
+    shouldRunTicks = true;
+    tickThread = new thread(&Console::TickLoop, this);
+}
+
+/* Runs a job on the tick thread between two ticks and waits for it, so the
+   console never touches scheduler state while a tick is running. Runs the
+   job directly when no tick thread exists (headless runs, paused ticks). */
+void Console::RunOnTick(const function<void()>& job) {
+    if (tickThread == nullptr) {
+        job();
+        return;
+    }
+
+    promise<void> done;
+    future<void> finished = done.get_future();
+    scheduler.Post([&job, &done]() {
+        job();
+        done.set_value();
+    });
+    finished.wait();
+}
+
+/* Returns a current snapshot of the scheduler, published by the tick thread. */
+shared_ptr<const SchedulerSnapshot> Console::Snapshot() {
+    RunOnTick([this]() { scheduler.PublishSnapshot(); });
+    return scheduler.GetSnapshot();
 }
 
 /* Creates a new process screen for user interaction.
-   Connects to Scheduler::CreateNewProcess() to spawn a process. */
+   Connects to Scheduler::CreateNewProcess() to spawn a process; the lookup
+   and creation run on the tick thread between ticks. */
 void Console::CreateScreen(const string& processName) {
-    Process* proc = scheduler.GetProcess(processName);
-    if (proc != nullptr) {
+    bool exists = false;
+    int pid = -1;
+    RunOnTick([&]() {
+        exists = scheduler.FindPID(processName) != -1;
+        if (!exists) {
+            scheduler.CreateNewProcess(processName);
+            Process* proc = scheduler.GetProcess(processName);
+            if (proc != nullptr) pid = proc->GetPID();
+        }
+    });
+
+    if (exists) {
         cout << "Process " << processName << " already exists." << endl;
         return;
     }
 
-    scheduler.CreateNewProcess(processName);
-    proc = scheduler.GetProcess(processName);
-
-    if (proc != nullptr) {
-        DisplayProcessScreen(proc); 
+    if (pid != -1) {
+        DisplayProcessScreen(pid, processName);
     }
 }
 
-/* Reattaches to an existing process screen.
-   Connects to Scheduler::GetProcess() to retrieve by name. */
+/* Reattaches to an existing process screen, live or retired.
+   Connects to Scheduler::FindPID() to retrieve by name. */
 void Console::SearchScreen(const string& processName) {
-    Process* proc = scheduler.GetProcess(processName);
+    int pid = -1;
+    string name;
+    RunOnTick([&]() {
+        pid = scheduler.FindPID(processName);
+        ProcessName key;
+        if (pid != -1 && ProcessName::Find(processName, key)) {
+            name = key.ToString();
+        }
+    });
 
-    if (proc == nullptr) {
+    if (pid == -1) {
         cout << "Process " << processName << " not found." << endl;
         return;
     }
 
-    DisplayProcessScreen(proc);
+    DisplayProcessScreen(pid, name);
 }
 
 /* Clears the screen and opens a dedicated interface for one process.
-   Handles process-specific commands like process-smi and exit. */
-void Console::DisplayProcessScreen(Process* proc) {
-    system("cls"); // comment out to see & verify the instruction types generated
+   The screen keeps only the PID; every process-smi asks the tick thread for
+   a fresh copy of the process. Handles process-specific commands like process-smi and exit. */
+void Console::DisplayProcessScreen(int pid, const string& processName) {
+    ClearScreen(); // comment out to see & verify the instruction types generated
 
-    cout << "Process name: " << proc->GetName() << endl;
+    cout << "Process name: " << processName << endl;
 
     bool inScreen = true;
     while (inScreen) {
@@ -102,19 +200,37 @@ void Console::DisplayProcessScreen(Process* proc) {
         getline(cin, command);
 
         if (command == "process-smi") {
-            // Try to assign the process to an idle core if it currently has -1
-            // to fix that -1 huhuhuhu
-            if (proc->GetCoreAssigned() == -1) {
-                bool assigned = scheduler.TryAssignProcess(proc);
-                if (assigned) {
-                    cout << "Process " << proc->GetName() << " assigned to core " << proc->GetCoreAssigned() << " immediately." << endl;
+            bool found = false;
+            int assignedCore = -1;
+            ProcessDetail detail;
+            RunOnTick([&]() {
+                Process* proc = scheduler.GetProcessByPID(pid);
+                if (proc == nullptr) {
+                    found = scheduler.GetRetiredDetail(pid, detail);
+                    return;
                 }
+                found = true;
+
+                // Try to assign the process to an idle core if it currently has -1
+                // to fix that -1 huhuhuhu
+                if (proc->GetCoreAssigned() == -1 && scheduler.TryAssignProcess(proc)) {
+                    assignedCore = proc->GetCoreAssigned();
+                }
+                detail = proc->GetDetail();
+            });
+
+            if (!found) {
+                cout << "Process " << processName << " no longer exists." << endl;
+                continue;
             }
-            proc->PrintInfo();
+            if (assignedCore != -1) {
+                cout << "Process " << processName << " assigned to core " << assignedCore << " immediately." << endl;
+            }
+            Process::PrintDetail(detail);
         }
         else if (command == "exit") {
             inScreen = false;
-            system("cls");
+            ClearScreen();
         }
         else {
             cout << "Unknown command in process screen." << endl;
@@ -123,48 +239,48 @@ void Console::DisplayProcessScreen(Process* proc) {
 }
 
 /* Lists all processes with their statuses and CPU utilization.
-   Connects to Scheduler methods to retrieve process lists and stats. */
+   Reads one published snapshot, so the list is consistent and the tick
+   thread is never held up while it prints. */
 void Console::ListScreens() {
+    shared_ptr<const SchedulerSnapshot> snap = Snapshot();
+
     cout << "CPU Utilization: " << fixed << setprecision(2)
-        << scheduler.GetCPUUtilization() << "%" << endl;
-    cout << "Cores used: " << scheduler.GetCoresUsed() << endl;
-    cout << "Cores available: " << scheduler.GetCoresAvailable() << endl;
+        << snap->cpuUtilization << "%" << endl;
+    cout << "Cores used: " << snap->coresUsed << endl;
+    cout << "Cores available: " << snap->numCPU - snap->coresUsed << endl;
     cout << "-----------------------------------------------" << endl << endl;
 
 	// Display running processes
     cout << "Running processes:" << endl;
-    auto runningProcs = scheduler.GetRunningProcesses();
-    if (runningProcs.empty()) {
+    if (snap->UnfinishedCount() == 0) {
         cout << "None" << endl;
     }
     else {
-        for (auto proc : runningProcs) {
-            time_t now = time(nullptr);
-            string ts = FormatTimestamp(now);
-            string status = proc->IsFinished() ? "Finished" : "Running";
-            cout << proc->GetName() << "   "
+        string ts = FormatTimestamp(SimClock::Now());
+        for (auto proc : snap->Unfinished()) {
+            cout << proc->name.ToString() << "   "
                 << "(" << ts << ")" << "   "
-                << status << "   "
-                << proc->GetCurrentLine()
-                << "/" << proc->GetTotalLines() << endl;
+                << "Running   "
+                << proc->currentLine
+                << "/" << proc->totalLines << endl;
         }
     }
 
 	// Display finished processes
     cout << "\nFinished processes:" << endl;
-    auto finishedProcs = scheduler.GetFinishedProcesses();
-    if (finishedProcs.empty()) {
+    if (snap->finishedCount == 0) {
         cout << "None" << endl;
     }
     else {
-        for (auto proc : finishedProcs) {
-            time_t tsTime = proc->GetFinishTime();
-            string ts = (tsTime != 0) ? FormatTimestamp(tsTime) : "N/A";
-            cout << proc->GetName() << "   "
-                << "(" << ts << ")" << "   "
-                << "Finished   "
-                << proc->GetTotalLines()
-                << "/" << proc->GetTotalLines() << endl;
+        for (const auto& chunk : snap->finished) {
+            for (const auto& proc : *chunk) {
+                string ts = (proc.finishTime != 0) ? FormatTimestamp(proc.finishTime) : "N/A";
+                cout << proc.name.ToString() << "   "
+                    << "(" << ts << ")" << "   "
+                    << "Finished   "
+                    << proc.totalLines
+                    << "/" << proc.totalLines << endl;
+            }
         }
     }
     cout << "-----------------------------------------------" << endl;
@@ -172,67 +288,207 @@ void Console::ListScreens() {
 
 /* Starts process generation via Scheduler. */
 void Console::SchedulerStart() {
-    scheduler.Start();
+    RunOnTick([this]() { scheduler.Start(); });
 }
 
 /* Stops automatic process generation. */
 void Console::SchedulerStop() {
-    scheduler.Stop();
+    RunOnTick([this]() { scheduler.Stop(); });
 }
 
 /* Generates a CPU utilization report into a log file.
-   Connects to Scheduler for process data and saves formatted output. */
-void Console::ReportUtil() {
-    ofstream logFile("csopesy-log.txt");
+   Takes one snapshot and hands it to the background ReportWriter, so the
+   console returns at once however many processes there are. */
+void Console::ReportUtil(const ReportRequest& request) {
+    shared_ptr<const SchedulerSnapshot> snap = Snapshot();
+    size_t processCount = snap->UnfinishedCount() + snap->finishedCount;
+    reports.Submit(snap, request, SimClock::Now());
+
+    cout << "Report " << (request.incremental ? "update" : "generation") << " started: " << request.fileName
+        << " (" << processCount << " processes, tick " << snap->cpuTicks << ")" << endl;
+}
+
+/* Prints the ready queue counters: current and peak depth, dispatches,
+   work steals and migrations. Used to check load balance. The counters are
+   copied on the tick thread, since the heap and MLFQ queues are not locked. */
+void Console::QueueStats() {
+    string description;
+    vector<pair<string, RunQueueStats>> rows;
+    RunOnTick([&]() {
+        const SchedulingPolicy& policy = scheduler.GetPolicy();
+        description = policy.GetDescription();
+        for (int i = 0; i < policy.GetQueueCount(); i++) {
+            rows.push_back(make_pair(policy.GetQueueName(i), policy.GetStats(i)));
+        }
+    });
 
-    if (!logFile.is_open()) {
-        cerr << "Error: Could not create log file." << endl;
+    cout << "Ready queue: " << description << endl;
+    cout << "-----------------------------------------------" << endl;
+    cout << left << setw(8) << "Queue" << setw(8) << "Depth" << setw(8) << "Peak"
+        << setw(12) << "Dispatched" << setw(10) << "Steals" << "Migrations" << endl;
+
+    for (const auto& row : rows) {
+        const RunQueueStats& stats = row.second;
+        cout << left << setw(8) << row.first
+            << setw(8) << stats.depth << setw(8) << stats.maxDepth
+            << setw(12) << stats.dispatched << setw(10) << stats.steals
+            << stats.migrations << endl;
+    }
+    cout << right << "-----------------------------------------------" << endl;
+}
+
+/* Prints the tick profile: per-phase latency (mean, p50, p99, max), budget
+   overruns and scheduler counters, after the achieved tick rate and missed
+   deadlines. Connects to Scheduler::GetMetrics() and the TickPacer. */
+void Console::VmStat() {
+    // Brings the clock up to date if the tick thread is sleeping through idle ticks
+    RunOnTick([]() {});
+    cout << "CPU ticks: " << SimClock::GetTick() << endl;
+    pacer.Report(cout);
+    cout << "-----------------------------------------------" << endl;
+    scheduler.GetMetrics().Report(cout);
+    cout << "-----------------------------------------------" << endl;
+}
+
+/* Saves the whole scheduler state to a binary checkpoint file.
+   Ticks are paused while writing. Connects to Scheduler::SaveCheckpoint(). */
+void Console::Checkpoint(const string& fileName) {
+    PauseTicks();
+    auto started = chrono::steady_clock::now();
+    string error;
+    bool saved = scheduler.SaveCheckpoint(fileName, error);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    size_t processCount = scheduler.GetAllProcesses().size() + scheduler.GetRetiredCount();
+    int tick = scheduler.GetCPUTicks();
+    ResumeTicks();
+
+    if (!saved) {
+        cout << "Checkpoint failed: " << error << endl;
         return;
     }
+    cout << "Checkpoint saved to " << fileName << " (" << processCount
+        << " processes, tick " << tick << ") in "
+        << fixed << setprecision(2) << seconds << " s" << endl;
+}
 
-    logFile << "CPU Utilization: " << fixed << setprecision(2)
-        << scheduler.GetCPUUtilization() << "%" << endl;
-    logFile << "Cores used: " << scheduler.GetCoresUsed() << endl;
-    logFile << "Cores available: " << scheduler.GetCoresAvailable() << endl;
-    logFile << "-----------------------------------------------" << endl << endl;
+/* Replaces the current state with a saved checkpoint. Ticks are paused while
+   loading. Connects to Scheduler::LoadCheckpoint(). */
+void Console::Restore(const string& fileName) {
+    PauseTicks();
+    auto started = chrono::steady_clock::now();
+    string error;
+    bool loaded = scheduler.LoadCheckpoint(fileName, error);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    size_t processCount = scheduler.GetAllProcesses().size() + scheduler.GetRetiredCount();
+    int tick = scheduler.GetCPUTicks();
+    ResumeTicks();
 
-    logFile << "Running processes:" << endl;
-    auto runningProcs = scheduler.GetRunningProcesses();
-    if (runningProcs.empty()) {
-        logFile << "None" << endl;
+    if (!loaded) {
+        cout << "Restore failed: " << error << endl;
+        return;
     }
-    else {
-        for (auto proc : runningProcs) {
-            time_t now = time(nullptr);
-            string ts = FormatTimestamp(now);
-            logFile << proc->GetName() << "   "
-                << "(" << ts << ")" << "   "
-				<< "Core: " << proc->GetCoreAssigned() << "   "
-                << proc->GetCurrentLine()
-                << "/" << proc->GetTotalLines() << endl;
-        }
+    cout << "Restored " << processCount << " processes at tick "
+        << tick << " from " << fileName << " in "
+        << fixed << setprecision(2) << seconds << " s" << endl;
+}
+
+// Longest slice a headless run asks for when the run has no tick limit
+static const long long HEADLESS_SLICE_TICKS = 1 << 20;
+
+/* Runs the simulation without the console: loads the config, ticks as fast as
+   the host allows and writes the utilization report at the end.
+   Timestamps come from SimClock's virtual time (msPerTick per tick, by
+   default one tick-rate period), so the report reads as if the run had
+   happened in real time.
+   Processes are generated for the first generateTicks ticks; the run ends at
+   options.ticks, or once generation is over and every process has finished. */
+int Console::RunHeadless(const HeadlessOptions& options) {
+    long long ticks = options.ticks;
+    long long generateTicks = options.generateTicks;
+    if (generateTicks < 0) {
+        generateTicks = (ticks > 0) ? ticks : 1000;
     }
 
-    logFile << "\nFinished processes:" << endl;
-    auto finishedProcs = scheduler.GetFinishedProcesses();
-    if (finishedProcs.empty()) {
-        logFile << "None" << endl;
+    scheduler.Initialize(options.configFile);
+    initialized = true;
+
+    int msPerTick = options.msPerTick;
+    if (msPerTick <= 0) {
+        double rate = scheduler.GetTickRate();
+        msPerTick = rate > 0 ? max(1, static_cast<int>(1000.0 / rate + 0.5)) : 100;
     }
-    else {
-		// Sort finished processes by finish time 
-        for (auto proc : finishedProcs) {
-            time_t now = time(nullptr);
-            string ts = FormatTimestamp(now);
-            logFile << proc->GetName() << "   "
-                << "(" << ts << ")" << "   "
-                << "Finished   "
-                << proc->GetTotalLines()
-                << "/" << proc->GetTotalLines() << endl;
+    SimClock::UseVirtualTime(time(nullptr), msPerTick);
+    scheduler.Start();
+
+    auto started = chrono::steady_clock::now();
+    long long executed = 0;
+    long long skipped = 0;
+    long long sliced = 0;
+    while (ticks == 0 || executed < ticks) {
+        if (executed == generateTicks && scheduler.IsRunning()) {
+            scheduler.Stop();
         }
+        if (!scheduler.IsRunning() && !scheduler.HasPendingWork()) {
+            break;
+        }
+
+        // Jump straight to the next event, stopping at the end of the run or of generation
+        long long idle = scheduler.CountIdleTicks();
+        if (idle != 0) {
+            long long limit = (ticks > 0) ? ticks - executed : LLONG_MAX;
+            if (scheduler.IsRunning()) {
+                limit = min(limit, generateTicks - executed);
+            }
+            if (idle < 0 && limit == LLONG_MAX) break;
+            long long jump = scheduler.SkipTicks((idle < 0) ? limit : min(idle, limit));
+            if (jump == 0) break;   // the tick counter is used up
+            executed += jump;
+            skipped += jump;
+            continue;
+        }
+
+        // Quiet stretches run as one slice per core, up to the end of the run or of generation
+        if (scheduler.IsSliced()) {
+            long long limit = (ticks > 0) ? ticks - executed : HEADLESS_SLICE_TICKS;
+            if (scheduler.IsRunning()) {
+                limit = min(limit, generateTicks - executed);
+            }
+            int ran = scheduler.RunSlice(static_cast<int>(min(limit, HEADLESS_SLICE_TICKS)));
+            if (ran > 0) {
+                executed += ran;
+                sliced += ran;
+                continue;
+            }
+        }
+
+        scheduler.Tick();
+        executed++;
     }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
 
-    logFile << "-----------------------------------------------" << endl;
-    logFile.close();
+    ReportRequest report;
+    report.format = options.reportFormat;
+    report.fileName = options.reportFile.empty() ? ReportWriter::DefaultFileName(report.format) : options.reportFile;
+    auto reportStarted = chrono::steady_clock::now();
+    ReportUtil(report);
+    reports.Wait();
+    double reportSeconds = chrono::duration<double>(chrono::steady_clock::now() - reportStarted).count();
 
-    cout << "Report generated: csopesy-log.txt" << endl;
-}
\ No newline at end of file
+    size_t total = scheduler.GetAllProcesses().size() + scheduler.GetRetiredCount();
+    size_t finished = scheduler.GetStateCount(FINISHED) + scheduler.GetRetiredCount();
+    double virtualSeconds = static_cast<double>(executed) * msPerTick / 1000.0;
+
+    cout << "-----------------------------------------------" << endl;
+    cout << "Ticks simulated: " << executed << " (" << skipped << " skipped as idle, "
+        << sliced << " run in slices)" << endl;
+    cout << "Simulated time: " << fixed << setprecision(1) << virtualSeconds << " s" << endl;
+    cout << "Processes created: " << total << endl;
+    cout << "Processes finished: " << finished << endl;
+    cout << "CPU Utilization: " << setprecision(2) << scheduler.GetCPUUtilization() << "%" << endl;
+    cout << "Host time: " << setprecision(3) << seconds << " s" << endl;
+    cout << "Report time: " << setprecision(3) << reportSeconds << " s" << endl;
+    cout << "Ticks/sec: " << setprecision(0) << (seconds > 0 ? executed / seconds : 0.0) << endl;
+    cout << "Speed-up over real time: " << setprecision(1) << (seconds > 0 ? virtualSeconds / seconds : 0.0) << "x" << endl;
+    cout << "-----------------------------------------------" << endl;
+    return 0;
+}
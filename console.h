@@ -4,19 +4,39 @@
 #include <string>
 #include <thread>
 #include <atomic>
+#include <functional>
+#include <memory>
 #include "scheduler.h"
+#include "report.h"
+#include "pacer.h"
 
 using namespace std;
 
+/* Command-line options for a non-interactive run (see Console::RunHeadless). */
+struct HeadlessOptions {
+    string configFile = "config.txt";
+    string reportFile = "";         // empty = default name for reportFormat
+    ReportFormat reportFormat = REPORT_TEXT;
+    long long ticks = 0;            // stop after this many ticks, 0 = run until drained
+    long long generateTicks = -1;   // generate processes for this many ticks, -1 = same as ticks
+    int msPerTick = 0;              // virtual time per tick, 0 = 1000 / tick-rate
+};
+
 class Console {
 private:
     bool initialized;
     Scheduler scheduler;
     thread* tickThread;
     atomic<bool> shouldRunTicks;
+    TickPacer pacer;
+    ReportWriter reports;
 
     void TickLoop();
-    void DisplayProcessScreen(Process* proc);
+    void PauseTicks();
+    void ResumeTicks();
+    void DisplayProcessScreen(int pid, const string& processName);
+    void RunOnTick(const function<void()>& job);
+    shared_ptr<const SchedulerSnapshot> Snapshot();
 
 public:
     Console();
@@ -31,7 +51,12 @@ public:
 
     void SchedulerStart();
     void SchedulerStop();
-    void ReportUtil();
+    void ReportUtil(const ReportRequest& request = ReportRequest());
+    int RunHeadless(const HeadlessOptions& options);
+    void QueueStats();
+    void VmStat();
+    void Checkpoint(const string& fileName);
+    void Restore(const string& fileName);
 
 	void ShowSchedulerLog(); // temporary, will remove later
 };
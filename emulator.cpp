@@ -2,7 +2,7 @@
 
 #include <iostream>
 #include <string>
-#include <windows.h>
+#include <sstream>
 #include "console.h"
 
 using namespace std;
@@ -22,7 +22,63 @@ void Welcome() {
     cout << "-----------------------------------------------\n" << endl;
 }
 
-int main() {
+/* Parses "report-util [file] [--format text|csv|json] [--incremental]".
+   Without a file name the report goes to csopesy-log.txt (.csv, .json). */
+bool ParseReportUtil(const string& command, ReportRequest& request) {
+    istringstream words(command);
+    string word;
+    words >> word;
+
+    string fileName;
+    while (words >> word) {
+        if (word == "--incremental") request.incremental = true;
+        else if (word == "--format") {
+            if (!(words >> word) || !ReportWriter::ParseFormat(word, request.format)) return false;
+        }
+        else if (fileName.empty() && word.rfind("--", 0) != 0) fileName = word;
+        else return false;
+    }
+    request.fileName = fileName.empty() ? ReportWriter::DefaultFileName(request.format) : fileName;
+    return true;
+}
+
+/* Parses "--headless [--config F] [--ticks N] [--generate-ticks N]
+   [--ms-per-tick N] [--report F] [--report-format F]". Returns false on a malformed command line. */
+bool ParseHeadless(int argc, char* argv[], HeadlessOptions& options) {
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        string value = argv[++i];
+
+        try {
+            if (arg == "--config") options.configFile = value;
+            else if (arg == "--report") options.reportFile = value;
+            else if (arg == "--ticks") options.ticks = stoll(value);
+            else if (arg == "--generate-ticks") options.generateTicks = stoll(value);
+            else if (arg == "--ms-per-tick") options.msPerTick = stoi(value);
+            else if (arg == "--report-format") {
+                if (!ReportWriter::ParseFormat(value, options.reportFormat)) return false;
+            }
+            else return false;
+        }
+        catch (const exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--headless") {
+        HeadlessOptions options;
+        if (!ParseHeadless(argc, argv, options)) {
+            cerr << "Usage: " << argv[0] << " --headless [--config file] [--ticks N] [--generate-ticks N] [--ms-per-tick N] [--report file] [--report-format text|csv|json]" << endl;
+            return 1;
+        }
+        Console console;
+        return console.RunHeadless(options);
+    }
+
     Welcome();
     Console console;
 	bool running = true;
@@ -42,7 +98,15 @@ int main() {
         }
         else if (command == "scheduler-start") console.SchedulerStart();
         else if (command == "scheduler-stop") console.SchedulerStop();
-        else if (command == "report-util") console.ReportUtil();
+        else if (command == "report-util" || command.rfind("report-util ", 0) == 0) {
+            ReportRequest request;
+            if (ParseReportUtil(command, request)) console.ReportUtil(request);
+            else cout << "Usage: report-util [file] [--format text|csv|json] [--incremental]" << endl;
+        }
+        else if (command == "queue-stats") console.QueueStats();
+        else if (command == "vmstat") console.VmStat();
+        else if (command.rfind("checkpoint ", 0) == 0) console.Checkpoint(command.substr(11));
+        else if (command.rfind("restore ", 0) == 0) console.Restore(command.substr(8));
         else if (command == "exit") running = false;
         else cout << "Unknown command. Please try again." << endl;
     }
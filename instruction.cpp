@@ -8,40 +8,32 @@
 using namespace std;
 
 /* PRINT instruction: Logs a message with timestamp and CPU core ID.
-   Called by Process::Execute() and stored via Process::AddOutput(). */
-PrintInstruction::PrintInstruction(const string& msg, Process* proc)
-    : Instruction(proc), message(msg) {
+   Called by Process::Execute(). Holds the MessageTable id, not the text. */
+PrintInstruction::PrintInstruction(uint32_t msgId, Process* proc)
+    : Instruction(proc), messageId(msgId) {
 }
 
-/* Executes the PRINT command. Creates formatted timestamp and core info.
-   Connects with Process::AddOutput() to record output into process logs. */
+/* Executes the PRINT command.
+   Connects with Process::LogPrint() which records the event in the process log. */
 void PrintInstruction::Execute() {
-    time_t now = time(nullptr);
-    tm local_tm;
-    localtime_s(&local_tm, &now);
-    char buf[64];
-    strftime(buf, sizeof(buf), "(%m/%d/%Y %I:%M:%S %p)", &local_tm);
-
-    int core = process->GetCoreAssigned();
-    string logEntry = string(buf) + " Core:" + to_string(core) + " \"" + message + "\"";
-    process->AddOutput(logEntry);
+    process->LogPrint(messageId);
 }
 
 /* DECLARE instruction: Creates a variable and assigns an initial value.
    Used to simulate variable declaration in the processs memory. */
-DeclareInstruction::DeclareInstruction(const string& var, uint16_t val, Process* proc)
-    : Instruction(proc), varName(var), value(val) {
+DeclareInstruction::DeclareInstruction(uint8_t var, uint16_t val, Process* proc)
+    : Instruction(proc), varSlot(var), value(val) {
 }
 
 /* Executes DECLARE by setting the variables value.
    Connects to Process::SetVariable(). */
 void DeclareInstruction::Execute() {
-    process->SetVariable(varName, value);
+    process->SetVariable(varSlot, value);
 }
 
 /* ADD instruction: Performs integer addition between variable and/or constant values.
    Logic clamps result to uint16_t range to simulate 16-bit arithmetic. */
-AddInstruction::AddInstruction(const string& result, const string& op1, uint16_t op2, Process* proc)
+AddInstruction::AddInstruction(uint8_t result, uint8_t op1, uint16_t op2, Process* proc)
     : Instruction(proc), resultVar(result), operand1(op1), operand2(op2), useVariable(false) {
 }
 
@@ -59,7 +51,7 @@ void AddInstruction::Execute() {
 
 /* SUBTRACT instruction: Performs integer subtraction.
    Clamps negative results to zero (unsigned integer behavior). */
-SubtractInstruction::SubtractInstruction(const string& result, const string& op1, uint16_t op2, Process* proc)
+SubtractInstruction::SubtractInstruction(uint8_t result, uint8_t op1, uint16_t op2, Process* proc)
     : Instruction(proc), resultVar(result), operand1(op1), operand2(op2), useVariable(false) {
 }
 
@@ -84,32 +76,27 @@ SleepInstruction::SleepInstruction(uint8_t cpuCycles, Process* proc)
 /* Executes SLEEP by setting process state and defining wait cycles.
    Scheduler later decrements wait time during Tick(). */
 void SleepInstruction::Execute() {
+    process->SetWaitCycles(cycles);
     process->SetState(WAITING);
 }
 
 /* FOR loop instruction: Contains nested instructions repeated multiple times.
-   Allows grouped operations to be executed sequentially. */
-ForLoopInstruction::ForLoopInstruction(const vector<Instruction*>& instructions, int numRepeats, Process* proc)
-    : Instruction(proc), loopInstructions(instructions), repeats(numRepeats),
+   Allows grouped operations to be executed sequentially.
+   The body array and its instructions are allocated in the process arena. */
+ForLoopInstruction::ForLoopInstruction(Instruction** instructions, int numInstructions, int numRepeats, Process* proc)
+    : Instruction(proc), loopInstructions(instructions), loopCount(numInstructions), repeats(numRepeats),
     currentIteration(0), currentInstructionIndex(0) {
 }
 
-/* Destructor: Cleans up dynamically allocated sub-instructions within the loop. */
-ForLoopInstruction::~ForLoopInstruction() {
-    for (auto instr : loopInstructions) {
-        delete instr;
-    }
-}
-
 /* Executes FOR loop by repeatedly executing each inner instruction for N iterations.
    Connects to other Instruction types and simulates simple looping logic. */
 void ForLoopInstruction::Execute() {
     if (currentIteration < repeats) {
-        if (currentInstructionIndex < loopInstructions.size()) {
+        if (currentInstructionIndex < loopCount) {
             loopInstructions[currentInstructionIndex]->Execute();
             currentInstructionIndex++;
 
-            if (currentInstructionIndex >= loopInstructions.size()) {
+            if (currentInstructionIndex >= loopCount) {
                 currentInstructionIndex = 0;
                 currentIteration++;
             }
@@ -10,56 +10,58 @@ using namespace std;
 
 class Process;
 
+/* Instructions live in their process's arena and are released with it in one
+   go, never deleted one by one, so they own no heap memory and have no
+   virtual destructor. */
 class Instruction {
 protected:
     Process* process;
 
 public:
     Instruction(Process* proc) : process(proc) {}
-    virtual ~Instruction() {}
     virtual void Execute() = 0;
 };
 
 class PrintInstruction : public Instruction {
 private:
-    string message;
+    uint32_t messageId;
 
 public:
-    PrintInstruction(const string& msg, Process* proc);
+    PrintInstruction(uint32_t msgId, Process* proc);
     void Execute() override;
 };
 
 class DeclareInstruction : public Instruction {
 private:
-    string varName;
+    uint8_t varSlot;
     uint16_t value;
 
 public:
-    DeclareInstruction(const string& var, uint16_t val, Process* proc);
+    DeclareInstruction(uint8_t var, uint16_t val, Process* proc);
     void Execute() override;
 };
 
 class AddInstruction : public Instruction {
 private:
-    string resultVar;
-    string operand1;
+    uint8_t resultVar;
+    uint8_t operand1;
     uint16_t operand2;
     bool useVariable;
 
 public:
-    AddInstruction(const string& result, const string& op1, uint16_t op2, Process* proc);
+    AddInstruction(uint8_t result, uint8_t op1, uint16_t op2, Process* proc);
     void Execute() override;
 };
 
 class SubtractInstruction : public Instruction {
 private:
-    string resultVar;
-    string operand1;
+    uint8_t resultVar;
+    uint8_t operand1;
     uint16_t operand2;
     bool useVariable;
 
 public:
-    SubtractInstruction(const string& result, const string& op1, uint16_t op2, Process* proc);
+    SubtractInstruction(uint8_t result, uint8_t op1, uint16_t op2, Process* proc);
     void Execute() override;
 };
 
@@ -74,14 +76,14 @@ public:
 
 class ForLoopInstruction : public Instruction {
 private:
-    vector<Instruction*> loopInstructions;
+    Instruction** loopInstructions;
+    int loopCount;
     int repeats;
     int currentIteration;
     int currentInstructionIndex;
 
 public:
-    ForLoopInstruction(const vector<Instruction*>& instructions, int numRepeats, Process* proc);
-    ~ForLoopInstruction();
+    ForLoopInstruction(Instruction** instructions, int numInstructions, int numRepeats, Process* proc);
     void Execute() override;
 };
 
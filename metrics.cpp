@@ -0,0 +1,179 @@
+/* Tick profiling: phase timers, latency histograms and scheduler counters */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include "metrics.h"
+
+using namespace std;
+
+static const char* PHASE_NAMES[PHASE_COUNT] = { "generate", "dispatch", "execute", "wake", "tick" };
+
+/* Constructor: an empty histogram. */
+LatencyHistogram::LatencyHistogram() {
+    Reset();
+}
+
+/* Adds one sample. Bucket b holds samples in [2^b, 2^(b+1)) ns. */
+void LatencyHistogram::Record(uint64_t ns) {
+    int bucket = 0;
+    for (uint64_t v = ns; v > 1 && bucket < BUCKETS - 1; v >>= 1) {
+        bucket++;
+    }
+
+    buckets[bucket].store(buckets[bucket].load(memory_order_relaxed) + 1, memory_order_relaxed);
+    count.store(count.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    totalNs.store(totalNs.load(memory_order_relaxed) + ns, memory_order_relaxed);
+    if (ns > maxNs.load(memory_order_relaxed)) {
+        maxNs.store(ns, memory_order_relaxed);
+    }
+}
+
+/* Clears all samples. */
+void LatencyHistogram::Reset() {
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i] = 0;
+    }
+    count = 0;
+    totalNs = 0;
+    maxNs = 0;
+}
+
+/* Mean latency in ns. */
+uint64_t LatencyHistogram::GetMean() const {
+    uint64_t n = GetCount();
+    return n > 0 ? totalNs.load(memory_order_relaxed) / n : 0;
+}
+
+/* Upper bound of the bucket holding the given fraction of samples
+   (e.g. 0.99 for p99). Accurate to within a factor of two. */
+uint64_t LatencyHistogram::GetPercentile(double fraction) const {
+    uint64_t n = GetCount();
+    if (n == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(fraction * n);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i].load(memory_order_relaxed);
+        if (seen > target) {
+            return min<uint64_t>(GetMax(), (2ULL << i) - 1);
+        }
+    }
+    return GetMax();
+}
+
+/* Constructor: enabled with a 100 ms budget, matching Console::TickLoop(). */
+TickMetrics::TickMetrics() : enabled(true), budgetNs(100000000ULL) {
+    Reset();
+}
+
+/* Turns profiling on or off and sets the per-tick budget used to count overruns.
+   Called by Scheduler::Initialize() from the metrics and tick-budget-ms keys. */
+void TickMetrics::Configure(bool on, int budgetMs) {
+    enabled = on;
+    budgetNs = static_cast<uint64_t>(budgetMs > 0 ? budgetMs : 100) * 1000000ULL;
+}
+
+/* Clears every histogram and counter. */
+void TickMetrics::Reset() {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        phases[i].Reset();
+    }
+    ticks = 0;
+    skippedTicks = 0;
+    slicedTicks = 0;
+    slices = 0;
+    overruns = 0;
+    processesCreated = 0;
+    generatorWaits = 0;
+    dispatches = 0;
+    preemptions = 0;
+    sleeps = 0;
+    completions = 0;
+    readyDepth = 0;
+    readyDepthMax = 0;
+    readyDepthSum = 0;
+    sleepingCount = 0;
+}
+
+/* Monotonic host time in ns. */
+uint64_t TickMetrics::Clock() {
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/* Records the time since start against phase and returns the new mark, so
+   consecutive phases need one clock read each. */
+uint64_t TickMetrics::EndPhase(TickPhase phase, uint64_t start) {
+    if (!enabled) return 0;
+    uint64_t now = Clock();
+    phases[phase].Record(now - start);
+    return now;
+}
+
+/* Closes a tick: whole-tick latency, budget overrun and queue depth gauges. */
+void TickMetrics::EndTick(uint64_t start, size_t ready, size_t sleeping) {
+    if (!enabled) return;
+    uint64_t elapsed = Clock() - start;
+    phases[PHASE_TICK].Record(elapsed);
+
+    Bump(ticks);
+    if (elapsed > budgetNs) {
+        Bump(overruns);
+    }
+
+    readyDepth.store(ready, memory_order_relaxed);
+    Bump(readyDepthSum, ready);
+    if (ready > readyDepthMax.load(memory_order_relaxed)) {
+        readyDepthMax.store(ready, memory_order_relaxed);
+    }
+    sleepingCount.store(sleeping, memory_order_relaxed);
+}
+
+/* Formats a duration in ns with a readable unit. */
+static string FormatNs(uint64_t ns) {
+    ostringstream out;
+    out << fixed << setprecision(1);
+    if (ns >= 1000000) out << ns / 1e6 << " ms";
+    else if (ns >= 1000) out << ns / 1e3 << " us";
+    else out << ns << " ns";
+    return out.str();
+}
+
+/* Writes the phase table and counters. Used by the vmstat command and the
+   periodic stats file. */
+void TickMetrics::Report(ostream& out) const {
+    if (!enabled) {
+        out << "Tick metrics are disabled (set \"metrics on\" in config.txt)." << endl;
+        return;
+    }
+
+    uint64_t tickCount = ticks.load(memory_order_relaxed);
+    out << left << setw(10) << "Phase" << right << setw(10) << "Samples" << setw(12) << "Mean"
+        << setw(12) << "p50" << setw(12) << "p99" << setw(12) << "Max" << endl;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const LatencyHistogram& h = phases[i];
+        out << left << setw(10) << PHASE_NAMES[i] << right << setw(10) << h.GetCount()
+            << setw(12) << FormatNs(h.GetMean()) << setw(12) << FormatNs(h.GetPercentile(0.5))
+            << setw(12) << FormatNs(h.GetPercentile(0.99)) << setw(12) << FormatNs(h.GetMax()) << endl;
+    }
+    out << "-----------------------------------------------" << endl;
+    out << "Ticks: " << tickCount << endl;
+    out << "Skipped ticks: " << skippedTicks.load(memory_order_relaxed) << endl;
+    out << "Sliced ticks: " << slicedTicks.load(memory_order_relaxed) << " in "
+        << slices.load(memory_order_relaxed) << " slices" << endl;
+    out << "Budget overruns: " << overruns.load(memory_order_relaxed)
+        << " (budget " << FormatNs(budgetNs) << ")" << endl;
+    out << "Processes created: " << processesCreated.load(memory_order_relaxed) << endl;
+    out << "Generator waits: " << generatorWaits.load(memory_order_relaxed) << endl;
+    out << "Dispatches: " << dispatches.load(memory_order_relaxed) << endl;
+    out << "Preemptions: " << preemptions.load(memory_order_relaxed) << endl;
+    out << "Sleeps: " << sleeps.load(memory_order_relaxed) << endl;
+    out << "Completions: " << completions.load(memory_order_relaxed) << endl;
+    out << "Ready queue depth: " << readyDepth.load(memory_order_relaxed)
+        << " (max " << readyDepthMax.load(memory_order_relaxed) << ", avg " << fixed << setprecision(1)
+        << (tickCount > 0 ? static_cast<double>(readyDepthSum.load(memory_order_relaxed)) / tickCount : 0.0)
+        << ")" << endl;
+    out << "Sleeping: " << sleepingCount.load(memory_order_relaxed) << endl;
+}
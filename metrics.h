@@ -0,0 +1,100 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+enum TickPhase {
+    PHASE_GENERATE,
+    PHASE_DISPATCH,
+    PHASE_EXECUTE,
+    PHASE_WAKE,
+    PHASE_TICK,     // whole Scheduler::Tick()
+    PHASE_COUNT
+};
+
+/* Latency histogram with power-of-two nanosecond buckets. Written only by
+   the tick thread; relaxed atomics let the console read it while it runs. */
+class LatencyHistogram {
+private:
+    static const int BUCKETS = 48;
+
+    atomic<uint64_t> buckets[BUCKETS];
+    atomic<uint64_t> count;
+    atomic<uint64_t> totalNs;
+    atomic<uint64_t> maxNs;
+
+public:
+    LatencyHistogram();
+
+    void Record(uint64_t ns);
+    void Reset();
+
+    uint64_t GetCount() const { return count.load(memory_order_relaxed); }
+    uint64_t GetMean() const;
+    uint64_t GetMax() const { return maxNs.load(memory_order_relaxed); }
+    uint64_t GetPercentile(double fraction) const;
+};
+
+/* Host-side profile of the tick path: per-phase latencies plus scheduler
+   counters. Every entry point checks the enabled flag first, so a disabled
+   TickMetrics costs one predictable branch per call and no clock reads. */
+class TickMetrics {
+private:
+    bool enabled;
+    uint64_t budgetNs;
+
+    LatencyHistogram phases[PHASE_COUNT];
+    atomic<uint64_t> ticks;
+    atomic<uint64_t> skippedTicks;  // jumped over by Scheduler::SkipTicks(), not timed
+    atomic<uint64_t> slicedTicks;   // run by Scheduler::RunSlice(), not timed
+    atomic<uint64_t> slices;
+    atomic<uint64_t> overruns;
+    atomic<uint64_t> processesCreated;
+    atomic<uint64_t> generatorWaits;     // times a due process was not built yet (waited for or deferred)
+    atomic<uint64_t> dispatches;
+    atomic<uint64_t> preemptions;
+    atomic<uint64_t> sleeps;
+    atomic<uint64_t> completions;
+    atomic<uint64_t> readyDepth;
+    atomic<uint64_t> readyDepthMax;
+    atomic<uint64_t> readyDepthSum;
+    atomic<uint64_t> sleepingCount;
+
+public:
+    TickMetrics();
+
+    void Configure(bool on, int budgetMs);
+    bool IsEnabled() const { return enabled; }
+    void Reset();
+
+    static uint64_t Clock();
+
+    /* Returns the start mark for a tick, 0 when disabled. */
+    uint64_t BeginTick() const { return enabled ? Clock() : 0; }
+    uint64_t EndPhase(TickPhase phase, uint64_t start);
+    void EndTick(uint64_t start, size_t ready, size_t sleeping);
+
+    void CountCreated() { if (enabled) Bump(processesCreated); }
+    void CountGeneratorWait() { if (enabled) Bump(generatorWaits); }
+    void CountDispatch() { if (enabled) Bump(dispatches); }
+    void CountPreemption() { if (enabled) Bump(preemptions); }
+    void CountSleep() { if (enabled) Bump(sleeps); }
+    void CountCompletion() { if (enabled) Bump(completions); }
+    void CountSkipped(uint64_t count) { if (enabled) Bump(skippedTicks, count); }
+    void CountSliced(uint64_t count) { if (enabled) { Bump(slicedTicks, count); Bump(slices); } }
+
+    void Report(ostream& out) const;
+
+private:
+    /* Single writer, so a relaxed load/store is enough and avoids a locked add. */
+    static void Bump(atomic<uint64_t>& counter, uint64_t by = 1) {
+        counter.store(counter.load(memory_order_relaxed) + by, memory_order_relaxed);
+    }
+};
+
+#endif
@@ -0,0 +1,357 @@
+/* Bounded binary process logs, message interning and on-disk spill */
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "outputlog.h"
+#include "platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+/* ---------- MessageTable ---------- */
+
+static mutex& MessageLock() {
+    static mutex lock;
+    return lock;
+}
+
+static vector<string>& MessageTexts() {
+    static vector<string> texts;
+    return texts;
+}
+
+static unordered_map<string, uint32_t>& MessageIds() {
+    static unordered_map<string, uint32_t> ids;
+    return ids;
+}
+
+/* Returns the id of a message template, adding it on first use.
+   Called at program generation time, never per PRINT. */
+uint32_t MessageTable::Intern(const string& text) {
+    lock_guard<mutex> guard(MessageLock());
+    auto it = MessageIds().find(text);
+    if (it != MessageIds().end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(MessageTexts().size());
+    MessageTexts().push_back(text);
+    MessageIds().emplace(text, id);
+    return id;
+}
+
+/* Builds the text of a message, putting the process name in place of "{}". */
+string MessageTable::Format(uint32_t messageId, const string& processName) {
+    string text;
+    {
+        lock_guard<mutex> guard(MessageLock());
+        if (messageId >= MessageTexts().size()) return string();
+        text = MessageTexts()[messageId];
+    }
+
+    size_t slot = text.find("{}");
+    if (slot != string::npos) {
+        text.replace(slot, 2, processName);
+    }
+    return text;
+}
+
+/* Returns every template, indexed by id. Used to save the table with a
+   checkpoint, since ids are only stable within one run. */
+vector<string> MessageTable::GetAll() {
+    lock_guard<mutex> guard(MessageLock());
+    return MessageTexts();
+}
+
+/* ---------- LogSpill ---------- */
+
+/* Constructor: spilling stays disabled until Open() is called. */
+LogSpill::LogSpill() : enabled(false), nextOffset(0) {
+    static atomic<unsigned> instances(0);
+    instance = instances++;
+    for (size_t i = 0; i < MAX_SEGMENTS; i++) {
+        segments[i].data = nullptr;
+        segments[i].file = -1;
+        segments[i].mapping = -1;
+    }
+}
+
+/* Destructor unmaps the segments; their files only hold data for the
+   lifetime of the emulator and are already unlinked. */
+LogSpill::~LogSpill() {
+    UnmapAll();
+}
+
+/* Enables spilling into segment files created under dir. */
+void LogSpill::Open(const string& dir) {
+    lock_guard<mutex> guard(mapLock);
+    directory = dir.empty() ? string(".") : dir;
+    enabled = true;
+}
+
+/* Returns the mapped segment holding offset, mapping it first if needed.
+   Segments are mapped once and stay at the same address until shutdown. */
+char* LogSpill::SegmentFor(uint64_t offset, bool create) {
+    size_t index = static_cast<size_t>(offset / SEGMENT_SIZE);
+    if (index >= MAX_SEGMENTS) return nullptr;
+
+    char* data = segments[index].data.load(memory_order_acquire);
+    if (data != nullptr || !create) return data;
+
+    lock_guard<mutex> guard(mapLock);
+    data = segments[index].data.load(memory_order_acquire);
+    if (data == nullptr) {
+        data = MapSegment(index);
+        segments[index].data.store(data, memory_order_release);
+    }
+    return data;
+}
+
+/* Creates one SEGMENT_SIZE file and maps it read/write. Caller holds mapLock.
+   The name carries the process id and spill area, and the file must not
+   exist yet, so two emulators sharing log-spill-dir never touch each
+   other's segments. The
+   file is deleted as soon as it is mapped (on Windows when the mapping
+   closes), so nothing is left behind even after a crash. */
+char* LogSpill::MapSegment(size_t index) {
+#ifdef _WIN32
+    unsigned long owner = GetCurrentProcessId();
+#else
+    unsigned long owner = static_cast<unsigned long>(getpid());
+#endif
+    char name[80];
+    snprintf(name, sizeof(name), "/csopesy-spill-%lu-%u-%04u.bin", owner, instance, static_cast<unsigned>(index));
+    string path = directory + name;
+    Segment& segment = segments[index];
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+        CREATE_NEW, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, static_cast<DWORD>(SEGMENT_SIZE), NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, SEGMENT_SIZE);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    segment.file = reinterpret_cast<intptr_t>(file);
+    segment.mapping = reinterpret_cast<intptr_t>(mapping);
+    return static_cast<char*>(view);
+#else
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return nullptr;
+
+    void* view = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(SEGMENT_SIZE)) == 0) {
+        view = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    unlink(path.c_str());
+    if (view == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    segment.file = fd;
+    return static_cast<char*>(view);
+#endif
+}
+
+/* Unmaps every segment; closing the last handle frees its file. */
+void LogSpill::UnmapAll() {
+    for (size_t i = 0; i < MAX_SEGMENTS; i++) {
+        Segment& segment = segments[i];
+        char* data = segment.data.load();
+        if (data == nullptr) continue;
+
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(reinterpret_cast<HANDLE>(segment.mapping));
+        CloseHandle(reinterpret_cast<HANDLE>(segment.file));
+#else
+        munmap(data, SEGMENT_SIZE);
+        close(static_cast<int>(segment.file));
+#endif
+        segment.data = nullptr;
+    }
+}
+
+/* Appends one record and returns its offset, or NO_RECORD if spilling is off
+   or the disk area is exhausted. Lock-free except when a new segment has to
+   be mapped. */
+uint64_t LogSpill::Append(const SpillRecord& record) {
+    if (!enabled) return NO_RECORD;
+
+    uint64_t offset = nextOffset.fetch_add(sizeof(SpillRecord));
+    char* segment = SegmentFor(offset, true);
+    if (segment == nullptr) return NO_RECORD;
+
+    memcpy(segment + offset % SEGMENT_SIZE, &record, sizeof(SpillRecord));
+    return offset;
+}
+
+/* Reads the record at offset. */
+bool LogSpill::Read(uint64_t offset, SpillRecord& record) {
+    if (offset == NO_RECORD) return false;
+
+    char* segment = SegmentFor(offset, false);
+    if (segment == nullptr) return false;
+
+    memcpy(&record, segment + offset % SEGMENT_SIZE, sizeof(SpillRecord));
+    return true;
+}
+
+/* ---------- OutputLog ---------- */
+
+/* Constructor: an empty log that keeps 64 events in memory and drops older ones. */
+OutputLog::OutputLog() : capacity(64), head(0), count(0), spill(nullptr),
+    spillHead(LogSpill::NO_RECORD), spilledCount(0), droppedCount(0) {}
+
+/* Sets the ring size and the spill area. Called once before the first Append(). */
+void OutputLog::Configure(size_t ringCapacity, LogSpill* spillArea) {
+    capacity = ringCapacity > 0 ? ringCapacity : 1;
+    spill = spillArea;
+}
+
+/* Records one event. When the ring is full the oldest event is moved to the
+   spill area first. The ring is allocated on the first PRINT, so processes
+   that never print cost nothing. */
+void OutputLog::Append(const LogEvent& event) {
+    if (ring.empty()) {
+        ring.resize(capacity);
+    }
+
+    if (count == capacity) {
+        SpillRecord record;
+        record.event = ring[head];
+        record.prev = spillHead;
+
+        uint64_t offset = (spill != nullptr) ? spill->Append(record) : LogSpill::NO_RECORD;
+        if (offset != LogSpill::NO_RECORD) {
+            spillHead = offset;
+            spilledCount++;
+        } else {
+            droppedCount++;
+        }
+
+        head = (head + 1) % capacity;
+        count--;
+    }
+
+    ring[(head + count) % capacity] = event;
+    count++;
+}
+
+/* Appends the events of a spill chain ending at head, oldest first, by
+   walking the on-disk links backwards. */
+static void CollectSpilled(LogSpill* spill, uint64_t head, vector<LogEvent>& events) {
+    size_t start = events.size();
+
+    uint64_t offset = head;
+    SpillRecord record;
+    while (spill != nullptr && offset != LogSpill::NO_RECORD && spill->Read(offset, record)) {
+        events.push_back(record.event);
+        offset = record.prev;
+    }
+    reverse(events.begin() + start, events.end());
+}
+
+/* Collects every retained event, oldest first: the spilled ones followed by
+   the ring. */
+void OutputLog::Collect(vector<LogEvent>& events) const {
+    CollectSpilled(spill, spillHead, events);
+
+    for (size_t i = 0; i < count; i++) {
+        events.push_back(ring[(head + i) % capacity]);
+    }
+}
+
+/* Copies what a reader needs to collect the log later without the process:
+   the spill chain head and the events still in the ring. Spilled records are
+   never rewritten, so the chain can be walked on another thread. */
+void OutputLog::Capture(LogReference& reference) const {
+    reference.spillHead = spillHead;
+    reference.spilledCount = spilledCount;
+    reference.droppedCount = droppedCount;
+    reference.resident.clear();
+    reference.resident.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        reference.resident.push_back(ring[(head + i) % capacity]);
+    }
+}
+
+/* Moves the whole log out when its process is retired: the ring is pushed
+   into the spill area and only the chain head is kept. The log is empty
+   afterwards. Called by Process::Retire(). */
+void OutputLog::Release(LogReference& reference) {
+    reference.spillHead = spillHead;
+    reference.spilledCount = spilledCount;
+    reference.droppedCount = droppedCount;
+    reference.resident.clear();
+
+    vector<LogEvent> newest;
+    newest.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        newest.push_back(ring[(head + i) % capacity]);
+    }
+    StoreLogEvents(newest.data(), newest.size(), spill, reference);
+
+    vector<LogEvent>().swap(ring);
+    head = 0;
+    count = 0;
+    spillHead = LogSpill::NO_RECORD;
+    spilledCount = 0;
+    droppedCount = 0;
+}
+
+/* Adds events (oldest first) to a retired log, extending its spill chain.
+   Once the spill area refuses a record, that event and the newer ones stay
+   in reference.resident so the order is kept. */
+void StoreLogEvents(const LogEvent* events, size_t count, LogSpill* spill, LogReference& reference) {
+    size_t i = 0;
+    if (reference.resident.empty()) {
+        for (; i < count && spill != nullptr; i++) {
+            SpillRecord record;
+            record.event = events[i];
+            record.prev = reference.spillHead;
+            uint64_t offset = spill->Append(record);
+            if (offset == LogSpill::NO_RECORD) break;
+
+            reference.spillHead = offset;
+            reference.spilledCount++;
+        }
+    }
+    reference.resident.insert(reference.resident.end(), events + i, events + count);
+}
+
+/* Collects the events of a retired log, oldest first. */
+void CollectLogEvents(const LogReference& reference, LogSpill* spill, vector<LogEvent>& events) {
+    CollectSpilled(spill, reference.spillHead, events);
+    events.insert(events.end(), reference.resident.begin(), reference.resident.end());
+}
+
+/* Formats an event the way PRINT output has always looked:
+   (MM/DD/YYYY HH:MM:SS AM) Core:N "message" */
+string FormatLogEvent(const LogEvent& event, const string& processName) {
+    time_t when = static_cast<time_t>(event.wallTime);
+    tm local_tm;
+    localtime_s(&local_tm, &when);
+    char buf[64];
+    strftime(buf, sizeof(buf), "(%m/%d/%Y %I:%M:%S %p)", &local_tm);
+
+    return string(buf) + " Core:" + to_string(event.core) + " \"" + MessageTable::Format(event.messageId, processName) + "\"";
+}
@@ -0,0 +1,126 @@
+#ifndef OUTPUTLOG_H
+#define OUTPUTLOG_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <ctime>
+
+using namespace std;
+
+/* One PRINT, recorded in binary form. Text is only built when the log is viewed. */
+struct LogEvent {
+    int64_t wallTime;
+    uint32_t tick;
+    uint32_t messageId;
+    int16_t core;
+    uint16_t reserved;
+    uint32_t padding;
+};
+
+static_assert(sizeof(LogEvent) == 24, "LogEvent must stay 24 bytes");
+
+/* On-disk form of a spilled event. prev links to the same process's previous
+   spilled record, so a process only has to remember its newest offset. */
+struct SpillRecord {
+    LogEvent event;
+    uint64_t prev;
+};
+
+static_assert(sizeof(SpillRecord) == 32, "SpillRecord must stay 32 bytes");
+
+/* Global table of message templates. Every distinct text is stored once;
+   "{}" in a template is replaced by the process name when formatted. */
+class MessageTable {
+public:
+    static uint32_t Intern(const string& text);
+    static string Format(uint32_t messageId, const string& processName);
+    static vector<string> GetAll();
+};
+
+/* Append-only spill area for log events that fell out of a process ring.
+   Backed by fixed-size memory-mapped segment files that are never remapped,
+   so appends from several worker threads only need an atomic offset bump. */
+class LogSpill {
+private:
+    static const size_t SEGMENT_SIZE = 16 << 20;
+    static const size_t MAX_SEGMENTS = 1024;
+
+    struct Segment {
+        atomic<char*> data;
+        intptr_t file;
+        intptr_t mapping;
+    };
+
+    string directory;
+    unsigned instance;      // tells apart the spill areas of one emulator in file names
+    bool enabled;
+    atomic<uint64_t> nextOffset;
+    Segment segments[MAX_SEGMENTS];
+    mutex mapLock;
+
+    char* SegmentFor(uint64_t offset, bool create);
+    char* MapSegment(size_t index);
+    void UnmapAll();
+
+public:
+    static const uint64_t NO_RECORD = ~0ULL;
+
+    LogSpill();
+    ~LogSpill();
+
+    LogSpill(const LogSpill&) = delete;
+    LogSpill& operator=(const LogSpill&) = delete;
+
+    void Open(const string& dir);
+    bool IsOpen() const { return enabled; }
+
+    uint64_t Append(const SpillRecord& record);
+    bool Read(uint64_t offset, SpillRecord& record);
+    uint64_t GetBytesWritten() const { return nextOffset.load(); }
+};
+
+/* What remains of a log after its process is retired: the newest spilled
+   record (older ones chain back from it) plus any events that could not be
+   spilled, which stay in memory. */
+struct LogReference {
+    uint64_t spillHead = LogSpill::NO_RECORD;
+    uint64_t spilledCount = 0;
+    uint64_t droppedCount = 0;
+    vector<LogEvent> resident;
+};
+
+/* Bounded per-process log. The newest events stay in a fixed-size ring in
+   memory; older ones move to the LogSpill (or are dropped without one). */
+class OutputLog {
+private:
+    vector<LogEvent> ring;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    LogSpill* spill;
+    uint64_t spillHead;
+    uint64_t spilledCount;
+    uint64_t droppedCount;
+
+public:
+    OutputLog();
+
+    void Configure(size_t ringCapacity, LogSpill* spillArea);
+    void Append(const LogEvent& event);
+    void Collect(vector<LogEvent>& events) const;
+    void Capture(LogReference& reference) const;
+    void Release(LogReference& reference);
+
+    uint64_t Size() const { return spilledCount + count; }
+    uint64_t GetDroppedCount() const { return droppedCount; }
+    LogSpill* GetSpill() const { return spill; }
+};
+
+void StoreLogEvents(const LogEvent* events, size_t count, LogSpill* spill, LogReference& reference);
+void CollectLogEvents(const LogReference& reference, LogSpill* spill, vector<LogEvent>& events);
+string FormatLogEvent(const LogEvent& event, const string& processName);
+
+#endif
@@ -0,0 +1,137 @@
+/* Deadline-based pacing of the interactive tick loop */
+
+#include <thread>
+#include <iomanip>
+#include <algorithm>
+#include "pacer.h"
+
+using namespace std;
+
+/* Constructor: unpaced until Configure() is called. */
+TickPacer::TickPacer() : rate(0), period(Clock::duration::zero()), maxBacklog(1), ticks(0), lateTicks(0),
+    catchUpWakeups(0), droppedTicks(0), maxBatch(0), skippedTicks(0), activeNs(0), segmentStartNs(0) {}
+
+int64_t TickPacer::ToNs(Clock::time_point t) {
+    return chrono::duration_cast<chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+/* Sets the target rate in ticks per second (0 or less = as fast as
+   possible) and the largest backlog worth catching up, and clears the
+   counters. Called once by Console::Initialize(). */
+void TickPacer::Configure(double ticksPerSecond, long long backlogLimit) {
+    rate = ticksPerSecond > 0 ? ticksPerSecond : 0;
+    period = rate > 0 ? chrono::duration_cast<Clock::duration>(chrono::duration<double>(1.0 / rate))
+                      : Clock::duration::zero();
+    maxBacklog = backlogLimit > 0 ? backlogLimit : 1;
+
+    ticks = 0;
+    lateTicks = 0;
+    catchUpWakeups = 0;
+    droppedTicks = 0;
+    maxBatch = 0;
+    skippedTicks = 0;
+    activeNs = 0;
+    segmentStartNs = 0;
+}
+
+/* Starts a paced segment: the first tick is due one period from now.
+   Called when the tick thread starts, including after PauseTicks(). */
+void TickPacer::Begin() {
+    segmentStart = Clock::now();
+    deadline = segmentStart + period;
+    segmentStartNs = ToNs(segmentStart);
+}
+
+/* Ends the segment so paused time does not count against the rate. */
+void TickPacer::End() {
+    activeNs += ToNs(Clock::now()) - ToNs(segmentStart);
+    segmentStartNs = 0;
+}
+
+/* Sleeps until the next deadline and returns how many ticks are due: 1 when
+   on time, more when earlier ticks overran and the loop has to catch up. */
+int TickPacer::Next() {
+    if (period == Clock::duration::zero()) {
+        return 1;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (now < deadline) {
+        this_thread::sleep_until(deadline);
+        now = Clock::now();
+    }
+
+    long long due = 1 + (now - deadline) / period;
+    if (due > maxBacklog) {
+        droppedTicks += static_cast<uint64_t>(due - maxBacklog);
+        deadline += (due - maxBacklog) * period;
+        due = maxBacklog;
+    }
+    if (due > 1) {
+        lateTicks += static_cast<uint64_t>(due - 1);
+        catchUpWakeups++;
+    }
+    if (static_cast<uint64_t>(due) > maxBatch) {
+        maxBatch = static_cast<uint64_t>(due);
+    }
+
+    deadline += due * period;
+    return static_cast<int>(due);
+}
+
+/* Counts finished ticks. Counting after the ticks rather than in Next()
+   keeps the achieved rate honest while a long catch-up batch is running. */
+void TickPacer::Ticked(int count) {
+    ticks.fetch_add(static_cast<uint64_t>(count), memory_order_relaxed);
+}
+
+/* When the tick ahead ticks after the next one is due. */
+TickPacer::Clock::time_point TickPacer::GetDeadline(long long ahead) const {
+    return deadline + min(ahead, 1LL << 30) * period;
+}
+
+/* Accounts for idle ticks the loop slept through instead of running: those
+   whose deadline has passed, at most idleTicks (-1 = no limit). Unpaced, a
+   bounded run of idle ticks is skipped at once. Returns how many to skip. */
+long long TickPacer::SkipIdle(long long idleTicks) {
+    long long skipped;
+    if (period == Clock::duration::zero()) {
+        skipped = max(0LL, idleTicks);
+    } else {
+        Clock::time_point now = Clock::now();
+        skipped = now < deadline ? 0 : 1 + (now - deadline) / period;
+        if (idleTicks >= 0) {
+            skipped = min(skipped, idleTicks);
+        }
+        deadline += skipped * period;
+    }
+
+    ticks += static_cast<uint64_t>(skipped);
+    skippedTicks += static_cast<uint64_t>(skipped);
+    return skipped;
+}
+
+/* Ticks per second actually run while the loop was active. */
+double TickPacer::GetAchievedRate() const {
+    int64_t ns = activeNs.load();
+    int64_t start = segmentStartNs.load();
+    if (start != 0) {
+        ns += ToNs(Clock::now()) - start;
+    }
+    return ns > 0 ? static_cast<double>(ticks.load()) * 1e9 / ns : 0.0;
+}
+
+/* Prints the pacing section of vmstat. */
+void TickPacer::Report(ostream& out) const {
+    out << fixed << setprecision(2);
+    if (rate <= 0) {
+        out << "Tick rate: " << GetAchievedRate() << "/s (unpaced)" << endl;
+        out << "Idle ticks skipped: " << skippedTicks.load() << endl;
+        return;
+    }
+    out << "Tick rate: " << GetAchievedRate() << "/s (target " << rate << "/s)" << endl;
+    out << "Idle ticks skipped: " << skippedTicks.load() << endl;
+    out << "Missed deadlines: " << lateTicks.load() << " ticks caught up in " << catchUpWakeups.load()
+        << " wakeups (largest batch " << maxBatch.load() << ")" << endl;
+    out << "Dropped ticks: " << droppedTicks.load() << " (backlog limit " << maxBacklog << ")" << endl;
+}
@@ -0,0 +1,59 @@
+#ifndef PACER_H
+#define PACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+using namespace std;
+
+/* Paces the interactive tick loop against absolute deadlines on the
+   monotonic clock. Tick N is due at start + N * period however long the
+   earlier ticks took, so sleep jitter and slow ticks do not add up into
+   drift. When the loop falls behind, Next() asks for several ticks at once
+   to catch up; a backlog beyond maxBacklog ticks is dropped and counted
+   instead of being chased forever. Idle ticks the loop sleeps through
+   (SkipIdle) keep their deadlines and count as run. Counters are atomics so the console
+   can report them while the tick thread runs. */
+class TickPacer {
+private:
+    typedef chrono::steady_clock Clock;
+
+    double rate;
+    Clock::duration period;         // zero = unpaced
+    long long maxBacklog;
+    Clock::time_point deadline;     // when the next tick is due
+    Clock::time_point segmentStart;
+
+    atomic<uint64_t> ticks;
+    atomic<uint64_t> lateTicks;     // ran after their deadline had passed by a period or more
+    atomic<uint64_t> catchUpWakeups;
+    atomic<uint64_t> droppedTicks;
+    atomic<uint64_t> maxBatch;
+    atomic<uint64_t> skippedTicks;  // idle ticks slept through instead of run
+    atomic<int64_t> activeNs;       // paced time in finished segments
+    atomic<int64_t> segmentStartNs; // start of the running segment, 0 when stopped
+
+    static int64_t ToNs(Clock::time_point t);
+
+public:
+    TickPacer();
+
+    void Configure(double ticksPerSecond, long long backlogLimit);
+    void Begin();
+    int Next();
+    void Ticked(int count = 1);
+    void End();
+
+    bool IsPaced() const { return period != Clock::duration::zero(); }
+    bool IsDue() const { return !IsPaced() || Clock::now() >= deadline; }
+    Clock::time_point GetDeadline(long long ahead) const;
+    long long SkipIdle(long long idleTicks);
+
+    double GetTargetRate() const { return rate; }
+    double GetAchievedRate() const;
+    void Report(ostream& out) const;
+};
+
+#endif
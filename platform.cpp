@@ -0,0 +1,23 @@
+/* Small portability layer over the MSVC-only calls */
+
+#include <cstdlib>
+#include <cerrno>
+#include "platform.h"
+
+using namespace std;
+
+#ifndef _WIN32
+/* MSVC's localtime_s (destination first) on top of POSIX localtime_r. */
+int localtime_s(tm* result, const time_t* timer) {
+    return localtime_r(timer, result) != nullptr ? 0 : errno;
+}
+#endif
+
+/* Clears the terminal. Used by Console when entering and leaving a screen. */
+void ClearScreen() {
+#ifdef _WIN32
+    system("cls");
+#else
+    system("clear");
+#endif
+}
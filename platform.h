@@ -0,0 +1,16 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <ctime>
+
+using namespace std;
+
+/* The emulator was written against the MSVC runtime. These fill in the
+   pieces other compilers lack so the same sources build everywhere. */
+#ifndef _WIN32
+int localtime_s(tm* result, const time_t* timer);
+#endif
+
+void ClearScreen();
+
+#endif
@@ -0,0 +1,326 @@
+/* Scheduling policies: FCFS/RR run queues, SJF/SRTF/priority heaps and MLFQ */
+
+#include <algorithm>
+#include "policy.h"
+#include "process.h"
+
+using namespace std;
+
+/* ---------- SchedulingPolicy ---------- */
+
+/* Builds the policy selected by the "scheduler" config key. */
+unique_ptr<SchedulingPolicy> SchedulingPolicy::Create(const PolicySettings& settings) {
+    int quantum = max(1, settings.quantumCycles);
+    switch (settings.type) {
+    case FCFS:
+        return unique_ptr<SchedulingPolicy>(new FifoPolicy(settings.numCores, settings.runQueueMode, 0));
+    case SJF:
+        return unique_ptr<SchedulingPolicy>(new HeapPolicy(HeapPolicy::KEY_REMAINING, false, "SJF"));
+    case SRTF:
+        return unique_ptr<SchedulingPolicy>(new HeapPolicy(HeapPolicy::KEY_REMAINING, true, "SRTF"));
+    case PRIORITY:
+        return unique_ptr<SchedulingPolicy>(new HeapPolicy(HeapPolicy::KEY_PRIORITY, true, "Priority"));
+    case MLFQ:
+        return unique_ptr<SchedulingPolicy>(new MlfqPolicy(settings.mlfqLevels, quantum, settings.mlfqBoostInterval));
+    default:
+        return unique_ptr<SchedulingPolicy>(new FifoPolicy(settings.numCores, settings.runQueueMode, quantum));
+    }
+}
+
+/* Display name, as printed by Scheduler::Initialize(). */
+const char* SchedulingPolicy::GetName(SchedulerType type) {
+    switch (type) {
+    case FCFS: return "FCFS";
+    case SJF: return "Shortest Job First";
+    case SRTF: return "Shortest Remaining Time First";
+    case PRIORITY: return "Priority (preemptive)";
+    case MLFQ: return "Multi-Level Feedback Queue";
+    default: return "Round Robin";
+    }
+}
+
+/* Value of the "scheduler" config key for a policy. */
+const char* SchedulingPolicy::GetKey(SchedulerType type) {
+    switch (type) {
+    case FCFS: return "fcfs";
+    case SJF: return "sjf";
+    case SRTF: return "srtf";
+    case PRIORITY: return "priority";
+    case MLFQ: return "mlfq";
+    default: return "rr";
+    }
+}
+
+/* Maps a "scheduler" config value to its policy. */
+bool SchedulingPolicy::ParseKey(const string& key, SchedulerType& type) {
+    for (SchedulerType candidate : { FCFS, ROUND_ROBIN, SJF, SRTF, PRIORITY, MLFQ }) {
+        if (key == GetKey(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ---------- FifoPolicy ---------- */
+
+/* Constructor sets up the run queues the way the scheduler always has. */
+FifoPolicy::FifoPolicy(int numCores, RunQueueMode mode, int quantumCycles) : quantum(quantumCycles) {
+    queues.Configure(numCores, mode, quantumCycles == 0);
+}
+
+string FifoPolicy::GetQueueName(int queueId) const {
+    return queues.GetMode() == PER_CORE ? to_string(queueId) : string("global");
+}
+
+string FifoPolicy::GetDescription() const {
+    return queues.GetMode() == PER_CORE ? "per-core FIFO" : "global FIFO";
+}
+
+/* ---------- HeapPolicy ---------- */
+
+/* Constructor: an empty heap. */
+HeapPolicy::HeapPolicy(KeyType key, bool preemptOnArrival, const string& policyName)
+    : keyType(key), preemptive(preemptOnArrival), name(policyName), nextSequence(0) {}
+
+/* Lines left for SJF/SRTF (the job length still to run), or the static
+   priority where a smaller number runs first. */
+long long HeapPolicy::KeyOf(const Process* proc) const {
+    if (keyType == KEY_PRIORITY) return proc->GetPriority();
+    return static_cast<long long>(proc->GetTotalLines()) - proc->GetCurrentLine();
+}
+
+/* Queues a process in O(log n). A queued process does not run, so its key
+   stays valid until it is popped. */
+void HeapPolicy::Push(Process* proc, int /*preferredCore*/) {
+    heap.push_back({ KeyOf(proc), nextSequence++, proc });
+    push_heap(heap.begin(), heap.end());
+
+    stats.enqueued++;
+    stats.depth = heap.size();
+    if (stats.depth > stats.maxDepth) {
+        stats.maxDepth = stats.depth;
+    }
+}
+
+/* Takes the process with the smallest key in O(log n). */
+Process* HeapPolicy::Pop(int coreId) {
+    if (heap.empty()) return nullptr;
+
+    pop_heap(heap.begin(), heap.end());
+    Process* proc = heap.back().proc;
+    heap.pop_back();
+
+    stats.dispatched++;
+    stats.depth = heap.size();
+    int lastCore = proc->GetCoreAssigned();
+    if (lastCore != -1 && lastCore != coreId) {
+        stats.migrations++;
+    }
+    return proc;
+}
+
+/* Linear scan; only used by process-smi through TryAssignProcess(). */
+bool HeapPolicy::Contains(Process* proc) const {
+    for (const auto& entry : heap) {
+        if (entry.proc == proc) return true;
+    }
+    return false;
+}
+
+/* Takes a process out of the heap and restores the heap order; O(n). */
+bool HeapPolicy::Remove(Process* proc) {
+    for (size_t i = 0; i < heap.size(); i++) {
+        if (heap[i].proc != proc) continue;
+
+        heap.erase(heap.begin() + i);
+        make_heap(heap.begin(), heap.end());
+        stats.depth = heap.size();
+        return true;
+    }
+    return false;
+}
+
+void HeapPolicy::Clear() {
+    heap.clear();
+    stats = RunQueueStats();
+    nextSequence = 0;
+}
+
+/* Appends the queued processes in the order they would run, so a checkpoint
+   restore that pushes them back in this order rebuilds the same schedule. */
+void HeapPolicy::Collect(int /*queueId*/, vector<Process*>& out) const {
+    vector<Entry> ordered(heap);
+    sort(ordered.begin(), ordered.end(), [](const Entry& a, const Entry& b) { return b < a; });
+    for (const auto& entry : ordered) {
+        out.push_back(entry.proc);
+    }
+}
+
+/* A strictly better queued process preempts, so equal keys never ping-pong. */
+bool HeapPolicy::ShouldPreempt(const Process* proc) const {
+    return !heap.empty() && heap.front().key < KeyOf(proc);
+}
+
+/* ---------- MlfqPolicy ---------- */
+
+/* Constructor: levelCount FIFO levels, level 0 on top. */
+MlfqPolicy::MlfqPolicy(int levelCount, int quantumCycles, int boostTicks)
+    : baseQuantum(quantumCycles), boostInterval(boostTicks), boostEpoch(0), lowEpoch(-1), total(0) {
+    // Capped so the doubled quantum of the lowest level cannot overflow
+    int count = min(max(1, levelCount), 16);
+    levels.resize(count);
+    stats.resize(count);
+}
+
+/* A level set before the last boost has been boosted back to 0. */
+int MlfqPolicy::LevelOf(const Process* proc) const {
+    if (proc->GetLevelEpoch() < boostEpoch) return 0;
+    return min(max(0, proc->GetPolicyLevel()), static_cast<int>(levels.size()) - 1);
+}
+
+/* Queues a process at the back of its level. A process that was running or
+   sleeping through a boost comes back at level 0. */
+void MlfqPolicy::Push(Process* proc, int /*preferredCore*/) {
+    int level = LevelOf(proc);
+    proc->SetPolicyLevel(level, boostEpoch);
+    if (level > 0) {
+        lowEpoch = boostEpoch;
+    }
+    levels[level].push_back(proc);
+    total++;
+
+    RunQueueStats& s = stats[level];
+    s.enqueued++;
+    s.depth = levels[level].size();
+    if (s.depth > s.maxDepth) {
+        s.maxDepth = s.depth;
+    }
+}
+
+/* Takes the front of the highest non-empty level. */
+Process* MlfqPolicy::Pop(int coreId) {
+    if (total == 0) return nullptr;
+
+    for (size_t level = 0; level < levels.size(); level++) {
+        if (levels[level].empty()) continue;
+
+        Process* proc = levels[level].front();
+        levels[level].pop_front();
+        total--;
+
+        RunQueueStats& s = stats[level];
+        s.dispatched++;
+        s.depth = levels[level].size();
+        int lastCore = proc->GetCoreAssigned();
+        if (lastCore != -1 && lastCore != coreId) {
+            s.migrations++;
+        }
+        return proc;
+    }
+    return nullptr;
+}
+
+bool MlfqPolicy::Contains(Process* proc) const {
+    for (const auto& level : levels) {
+        if (find(level.begin(), level.end(), proc) != level.end()) return true;
+    }
+    return false;
+}
+
+bool MlfqPolicy::Remove(Process* proc) {
+    for (size_t level = 0; level < levels.size(); level++) {
+        auto it = find(levels[level].begin(), levels[level].end(), proc);
+        if (it == levels[level].end()) continue;
+
+        levels[level].erase(it);
+        total--;
+        stats[level].depth = levels[level].size();
+        return true;
+    }
+    return false;
+}
+
+void MlfqPolicy::Clear() {
+    for (auto& level : levels) {
+        level.clear();
+    }
+    for (auto& s : stats) {
+        s = RunQueueStats();
+    }
+    total = 0;
+}
+
+void MlfqPolicy::Collect(int queueId, vector<Process*>& out) const {
+    if (queueId < 0 || queueId >= static_cast<int>(levels.size())) return;
+    out.insert(out.end(), levels[queueId].begin(), levels[queueId].end());
+}
+
+RunQueueStats MlfqPolicy::GetStats(int queueId) const {
+    if (queueId < 0 || queueId >= static_cast<int>(stats.size())) {
+        return RunQueueStats();
+    }
+    return stats[queueId];
+}
+
+string MlfqPolicy::GetDescription() const {
+    return "MLFQ, " + to_string(levels.size()) + " levels, quantum " + to_string(baseQuantum) + " doubling per level";
+}
+
+/* A process that used its whole quantum is CPU-bound: move it down a level. */
+void MlfqPolicy::OnQuantumExpired(Process* proc) {
+    int level = LevelOf(proc);
+    if (level + 1 < static_cast<int>(levels.size())) {
+        proc->SetPolicyLevel(level + 1, boostEpoch);
+        lowEpoch = boostEpoch;
+    }
+}
+
+/* A process waiting on a higher level takes the core. */
+bool MlfqPolicy::ShouldPreempt(const Process* proc) const {
+    if (total == 0) return false;
+
+    int running = LevelOf(proc);
+    for (int level = 0; level < running; level++) {
+        if (!levels[level].empty()) return true;
+    }
+    return false;
+}
+
+/* Next boost tick, or -1 while no process (queued, running or sleeping)
+   has gone below level 0 since the last boost and a boost would change
+   nothing. */
+int MlfqPolicy::NextTickEvent(int tick) const {
+    if (boostInterval <= 0 || lowEpoch != boostEpoch) return -1;
+    return (tick / boostInterval + 1) * boostInterval;
+}
+
+/* Priority boost: every boostInterval ticks a new boost epoch starts and
+   every queued process goes back to level 0, keeping the order between
+   levels. Running and sleeping processes are reset by LevelOf() and Push(). */
+void MlfqPolicy::OnTick(int tick) {
+    if (boostInterval <= 0 || tick % boostInterval != 0 || levels.size() < 2) return;
+
+    boostEpoch = tick / boostInterval;
+    for (size_t level = 1; level < levels.size(); level++) {
+        for (auto proc : levels[level]) {
+            proc->SetPolicyLevel(0, boostEpoch);
+            levels[0].push_back(proc);
+        }
+        levels[level].clear();
+        stats[level].depth = 0;
+    }
+    stats[0].depth = levels[0].size();
+    if (stats[0].depth > stats[0].maxDepth) {
+        stats[0].maxDepth = stats[0].depth;
+    }
+}
+
+/* Picks up the boost epoch of a restored run. Processes may still sit below
+   level 0, so the next boost is treated as due. */
+void MlfqPolicy::OnRestore(int tick) {
+    if (boostInterval > 0) {
+        boostEpoch = tick / boostInterval;
+    }
+    lowEpoch = boostEpoch;
+}
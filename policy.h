@@ -0,0 +1,215 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include "runqueue.h"
+
+using namespace std;
+
+class Process;
+
+enum SchedulerType {
+    FCFS,
+    ROUND_ROBIN,
+    SJF,
+    SRTF,
+    PRIORITY,
+    MLFQ
+};
+
+/* The part of Config a policy needs. */
+struct PolicySettings {
+    SchedulerType type = ROUND_ROBIN;
+    int numCores = 4;
+    RunQueueMode runQueueMode = PER_CORE;
+    int quantumCycles = 5;
+    int mlfqLevels = 3;
+    int mlfqBoostInterval = 1000;
+};
+
+/* Decides which ready process runs next and when a running one must give up
+   its core. The scheduler owns the cores and the quantum counters; the policy
+   owns the ready processes. Push/Pop are O(1) for the FIFO policies and
+   O(log n) for the heap-based ones. */
+class SchedulingPolicy {
+public:
+    virtual ~SchedulingPolicy() {}
+
+    virtual void Push(Process* proc, int preferredCore) = 0;
+    virtual Process* Pop(int coreId) = 0;
+    virtual size_t Size() const = 0;
+    virtual bool Contains(Process* proc) const = 0;
+    virtual bool Remove(Process* proc) = 0;
+    virtual void Clear() = 0;
+    bool Empty() const { return Size() == 0; }
+
+    // Queues as shown by queue-stats and saved by checkpoints, best first
+    virtual int GetQueueCount() const = 0;
+    virtual string GetQueueName(int queueId) const = 0;
+    virtual void Collect(int queueId, vector<Process*>& out) const = 0;
+    virtual RunQueueStats GetStats(int queueId) const = 0;
+    virtual string GetDescription() const = 0;
+
+    // Time slicing: ticks a process may hold a core, 0 = until it sleeps or finishes
+    virtual bool UsesQuantum() const { return false; }
+    virtual int GetQuantum(const Process* /*proc*/) const { return 0; }
+    virtual void OnQuantumExpired(Process* /*proc*/) {}
+
+    // Preemption on arrival: true when the best ready process should take
+    // the core from proc. Only asked when IsPreemptive() is true.
+    virtual bool IsPreemptive() const { return false; }
+    virtual bool ShouldPreempt(const Process* /*proc*/) const { return false; }
+
+    // FCFS has always filled idle cores before executing; the others after
+    virtual bool DispatchesBeforeExecute() const { return false; }
+
+    virtual void OnTick(int /*tick*/) {}
+    // First tick after tick at which OnTick() changes anything, -1 = none
+    virtual int NextTickEvent(int /*tick*/) const { return -1; }
+    // Called after a checkpoint restore, before the first tick from tick
+    virtual void OnRestore(int /*tick*/) {}
+    // Queue that Push() gives the next process without a preferred core, saved with checkpoints
+    virtual int GetPushCursor() const { return 0; }
+    virtual void SetPushCursor(int /*queueId*/) {}
+
+    static unique_ptr<SchedulingPolicy> Create(const PolicySettings& settings);
+    static const char* GetName(SchedulerType type);
+    static const char* GetKey(SchedulerType type);
+    static bool ParseKey(const string& key, SchedulerType& type);
+};
+
+/* FCFS and Round Robin over the existing run queues (global FIFO or per-core
+   with work stealing). A quantum of 0 is FCFS. */
+class FifoPolicy : public SchedulingPolicy {
+private:
+    RunQueues queues;
+    int quantum;
+
+public:
+    FifoPolicy(int numCores, RunQueueMode mode, int quantumCycles);
+
+    void Push(Process* proc, int preferredCore) override { queues.Push(proc, preferredCore); }
+    Process* Pop(int coreId) override { return queues.Pop(coreId); }
+    size_t Size() const override { return queues.Size(); }
+    bool Contains(Process* proc) const override { return queues.Contains(proc); }
+    bool Remove(Process* proc) override { return queues.Remove(proc); }
+    void Clear() override { queues.Clear(); }
+
+    int GetQueueCount() const override { return queues.GetQueueCount(); }
+    string GetQueueName(int queueId) const override;
+    void Collect(int queueId, vector<Process*>& out) const override { queues.Collect(queueId, out); }
+    RunQueueStats GetStats(int queueId) const override { return queues.GetStats(queueId); }
+    string GetDescription() const override;
+
+    bool UsesQuantum() const override { return quantum > 0; }
+    int GetQuantum(const Process* /*proc*/) const override { return quantum; }
+    bool DispatchesBeforeExecute() const override { return quantum == 0; }
+
+    int GetPushCursor() const override { return queues.GetNextCore(); }
+    void SetPushCursor(int queueId) override { queues.SetNextCore(queueId); }
+};
+
+/* One global binary heap ordered by a key taken when the process is queued:
+   remaining lines for SJF/SRTF, static priority for PRIORITY. Ties go to
+   whoever was queued first. The preemptive variants let a better arrival
+   take a core from a worse running process. */
+class HeapPolicy : public SchedulingPolicy {
+public:
+    enum KeyType {
+        KEY_REMAINING,
+        KEY_PRIORITY
+    };
+
+private:
+    struct Entry {
+        long long key;
+        unsigned long long sequence;
+        Process* proc;
+
+        // Makes std::*_heap (a max-heap) keep the smallest key on top
+        bool operator<(const Entry& other) const {
+            if (key != other.key) return key > other.key;
+            return sequence > other.sequence;
+        }
+    };
+
+    vector<Entry> heap;
+    KeyType keyType;
+    bool preemptive;
+    string name;
+    unsigned long long nextSequence;
+    RunQueueStats stats;
+
+    long long KeyOf(const Process* proc) const;
+
+public:
+    HeapPolicy(KeyType key, bool preemptOnArrival, const string& policyName);
+
+    void Push(Process* proc, int preferredCore) override;
+    Process* Pop(int coreId) override;
+    size_t Size() const override { return heap.size(); }
+    bool Contains(Process* proc) const override;
+    bool Remove(Process* proc) override;
+    void Clear() override;
+
+    int GetQueueCount() const override { return 1; }
+    string GetQueueName(int /*queueId*/) const override { return "heap"; }
+    void Collect(int queueId, vector<Process*>& out) const override;
+    RunQueueStats GetStats(int /*queueId*/) const override { return stats; }
+    string GetDescription() const override { return name + " heap"; }
+
+    bool IsPreemptive() const override { return preemptive; }
+    bool ShouldPreempt(const Process* proc) const override;
+};
+
+/* Multi-level feedback queue. New processes start at level 0; using up a
+   whole quantum moves a process one level down, and each level's quantum is
+   twice the one above, so CPU-bound work ends up in long, rare slices while
+   short and sleeping processes stay on top. Every boostInterval ticks every
+   process returns to level 0 so nothing starves: the queued ones are moved
+   at once, and a running or sleeping process whose level was set before the
+   last boost (an older boost epoch) counts as level 0 from then on. */
+class MlfqPolicy : public SchedulingPolicy {
+private:
+    vector<deque<Process*>> levels;
+    vector<RunQueueStats> stats;
+    int baseQuantum;
+    int boostInterval;
+    int boostEpoch;     // boosts so far: tick of the last boost / boostInterval
+    int lowEpoch;       // last epoch in which a process went below level 0
+    size_t total;
+
+    int LevelOf(const Process* proc) const;
+
+public:
+    MlfqPolicy(int levelCount, int quantumCycles, int boostTicks);
+
+    void Push(Process* proc, int preferredCore) override;
+    Process* Pop(int coreId) override;
+    size_t Size() const override { return total; }
+    bool Contains(Process* proc) const override;
+    bool Remove(Process* proc) override;
+    void Clear() override;
+
+    int GetQueueCount() const override { return static_cast<int>(levels.size()); }
+    string GetQueueName(int queueId) const override { return "L" + to_string(queueId); }
+    void Collect(int queueId, vector<Process*>& out) const override;
+    RunQueueStats GetStats(int queueId) const override;
+    string GetDescription() const override;
+
+    bool UsesQuantum() const override { return true; }
+    int GetQuantum(const Process* proc) const override { return baseQuantum << LevelOf(proc); }
+    void OnQuantumExpired(Process* proc) override;
+
+    bool IsPreemptive() const override { return true; }
+    bool ShouldPreempt(const Process* proc) const override;
+
+    void OnTick(int tick) override;
+    int NextTickEvent(int tick) const override;
+    void OnRestore(int tick) override;
+};
+
+#endif
@@ -5,76 +5,258 @@
 #include <ctime>
 #include <algorithm>
 #include "process.h"
+#include "simclock.h"
 
 using namespace std;
 
 /* Constructor: Builds a new process instance with randomized instructions.
-   Uses rand() to randomly select between instruction types and connects 
-   directly with Scheduler::CreateNewProcess() which calls this constructor. */
-Process::Process(string processName, int processId, int numInstructions, int delaysPerExec)
-    : name(processName), pid(processId), state(READY), currentLine(0),
-    coreAssigned(-1), waitCycles(0), executionTime(0), delayCounter(0), finishTime(0) {
+   A per-process ProgramGenerator seeded from the master seed and PID picks
+   the instruction types and connects directly with Scheduler::CreateNewProcess()
+   which calls this constructor.
+   The generator always emits compact bytecode; the object backend is built
+   from it afterwards so both backends run the exact same program.
+   With options.lazyWindow > 0 (bytecode only) nothing is generated here:
+   the process keeps the seed and produces its lines in windows as it runs.
+   Ops and instruction objects are allocated in the given arena (normally
+   from ProcessPool); without one the process creates its own. */
+Process::Process(const ProcessName& processName, int processId, int numInstructions, int delaysPerExec,
+    const ProgramOptions& options, Arena* memory)
+    : name(processName), pid(processId), state(READY), currentLine(0), totalLines(numInstructions),
+    backend(options.backend), arena(memory != nullptr ? memory : new Arena()), ownsArena(memory == nullptr),
+    program(arena), seed(DeriveSeed(options.seed, static_cast<uint64_t>(processId), STREAM_PROGRAM)), windowStart(0),
+    lazyWindow(options.backend == BACKEND_BYTECODE ? options.lazyWindow : 0), optimize(options.optimize),
+    loopIteration(0), loopIndex(0), instructions(ArenaAllocator<Instruction*>(arena)),
+    coreAssigned(-1), waitCycles(0), executionTime(0), delayCounter(0), delaysPerExec(max(0, delaysPerExec)),
+    priority(0), policyLevel(0), levelEpoch(0), finishTick(0), finishTime(0), stampTick(0), quietEnd(0) {
 
-    srand(time(NULL) + processId);
+    generator.Start(seed, program);
+    outputLog.Configure(static_cast<size_t>(options.logCapacity), options.logSpill);
+    variables.assign(program.symbols.size(), 0);
+    declared.assign(program.symbols.size(), false);
 
-    for (int i = 0; i < numInstructions; i++) {
-        int processInstruction = rand() % 6;
-        
-		/* ONLY FOR CHECKING, use with Console::DisplayProcessScreen()'s cls
-        cout << name << " Instruction " << i
-             << " type: " << processInstruction << endl;*/
+    if (lazyWindow > 0) return;
 
-        if (processInstruction == 0) {
-            // PRINT instruction
-            instructions.push_back(new PrintInstruction("Hello world from " + name + "!", this));
-        }
-        else if (processInstruction == 1) {
-            // DECLARE instruction
-            string varName = "var" + to_string(rand() % 10);
-            uint16_t value = rand() % 1000;
-            instructions.push_back(new DeclareInstruction(varName, value, this));
-        }
-        else if (processInstruction == 2) {
-            // ADD instruction
-            string var1 = "var" + to_string(rand() % 10);
-            string var2 = "var" + to_string(rand() % 10);
-            uint16_t value = rand() % 100;
-            instructions.push_back(new AddInstruction(var1, var2, value, this));
-        }
-        else if (processInstruction == 3) {
-            // SUBTRACT instruction
-            string var1 = "var" + to_string(rand() % 10);
-            string var2 = "var" + to_string(rand() % 10);
-            uint16_t value = rand() % 100;
-            instructions.push_back(new SubtractInstruction(var1, var2, value, this));
-        }
-        else if (processInstruction == 4) {
-            // SLEEP instruction
-            uint8_t cycles = (rand() % 5) + 1;
-            instructions.push_back(new SleepInstruction(cycles, this));
-        }
-        else {
-            // FOR loop instruction
-            int loopRepeats = (rand() % 3) + 2;
-            int loopInstructions = (rand() % 3) + 1;
-            vector<Instruction*> loopBody;
-
-            for (int j = 0; j < loopInstructions; j++) {
-                loopBody.push_back(new PrintInstruction("Hello world from " + name + "!", this));
-            }
+    program.ops.reserve(totalLines);
+    for (int i = 0; i < totalLines; i++) {
+        program.ops.push_back(generator.Next(program));
+    }
+    if (optimize) {
+        program.Optimize();
+    }
 
-            instructions.push_back(new ForLoopInstruction(loopBody, loopRepeats, this));
+    if (backend == BACKEND_OBJECTS) {
+        BuildInstructions();
+    }
+}
+
+/* Lazy mode: replaces the current window with the next lazyWindow lines,
+   starting at currentLine. The generator continues where the last window
+   stopped, so the lines are the same as an eager process would have. */
+void Process::GenerateWindow() {
+    windowStart = currentLine;
+    program.ops.clear();
+    program.loopBodies.clear();
+
+    int count = min(lazyWindow, totalLines - currentLine);
+    for (int i = 0; i < count; i++) {
+        program.ops.push_back(generator.Next(program));
+    }
+    if (optimize) {
+        program.Optimize();
+    }
+}
+
+/* Replaces the generated program with the given ops and rewinds to line 0.
+   Used by the benchmark to run programs made of a single instruction type. */
+void Process::LoadProgram(const vector<Op>& ops, const vector<Op>& loopBodies) {
+    program.ops.assign(ops.begin(), ops.end());
+    program.loopBodies.assign(loopBodies.begin(), loopBodies.end());
+    totalLines = static_cast<int>(ops.size());
+    currentLine = 0;
+    windowStart = 0;
+    quietEnd = 0;
+    lazyWindow = 0;
+    loopIteration = 0;
+    loopIndex = 0;
+    state = READY;
+
+    instructions.clear();
+    if (backend == BACKEND_OBJECTS) {
+        BuildInstructions();
+    }
+}
+
+/* Copies the execution state into a checkpoint record and appends the
+   variable values to vars and the core history to cores. The program itself (GetProgram()) and the log
+   (GetLog()) are written separately by Scheduler::SaveCheckpoint(). */
+void Process::SaveState(ProcessRecord& record, vector<uint16_t>& vars, vector<uint16_t>& cores) const {
+    record.seed = seed;
+    record.generatorState = generator.GetState();
+    record.finishTime = static_cast<int64_t>(finishTime);
+    record.opCount = static_cast<uint32_t>(program.ops.size());
+    record.bodyCount = static_cast<uint32_t>(program.loopBodies.size());
+
+    record.varIndex = vars.size();
+    record.varCount = static_cast<uint32_t>(variables.size());
+    record.declaredMask = 0;
+    for (size_t i = 0; i < variables.size(); i++) {
+        vars.push_back(variables[i]);
+        if (declared[i] && i < 32) {
+            record.declaredMask |= 1u << i;
         }
     }
 
-    totalLines = instructions.size();
+    record.pid = pid;
+    record.state = static_cast<int32_t>(state);
+    record.backend = static_cast<int32_t>(backend);
+    record.currentLine = currentLine;
+    record.totalLines = totalLines;
+    record.windowStart = windowStart;
+    record.lazyWindow = lazyWindow;
+    record.loopIteration = loopIteration;
+    record.loopIndex = loopIndex;
+    record.coreAssigned = coreAssigned;
+    record.waitCycles = waitCycles;
+    record.executionTime = executionTime;
+    record.delayCounter = delayCounter;
+    record.priority = priority;
+    record.policyLevel = policyLevel;
+    record.levelEpoch = levelEpoch;
+    record.finishTick = finishTick;
+
+    record.coreIndex = cores.size();
+    record.coreCount = static_cast<uint32_t>(coreHistory.size());
+    cores.insert(cores.end(), coreHistory.begin(), coreHistory.end());
+}
+
+/* Rebuilds a freshly created process from a checkpoint record. ops points at
+   opCount program ops followed by bodyCount loop-body ops, vars at varCount
+   values, cores at coreCount core ids and events at eventCount log events,
+   all inside the mapped file.
+   Message ids are translated through messageMap; the object backend is
+   lowered again from the restored ops. */
+void Process::RestoreState(const ProcessRecord& record, const Op* ops, const uint16_t* vars,
+    const uint16_t* cores, const LogEvent* events, const vector<uint32_t>& messageMap) {
+    auto remap = [&messageMap](uint32_t id) {
+        return id < messageMap.size() ? messageMap[id] : id;
+    };
+
+    // The constructor already set up the symbols and message ids; only the
+    // random stream has to continue where the saved process left off
+    seed = record.seed;
+    generator.SetState(record.generatorState);
+
+    program.ops.assign(ops, ops + record.opCount);
+    program.loopBodies.assign(ops + record.opCount, ops + record.opCount + record.bodyCount);
+    for (auto& op : program.ops) {
+        if (op.code == OP_PRINT) op.imm = remap(op.imm);
+    }
+    for (auto& op : program.loopBodies) {
+        if (op.code == OP_PRINT) op.imm = remap(op.imm);
+    }
+
+    variables.assign(vars, vars + record.varCount);
+    declared.assign(record.varCount, false);
+    for (uint32_t i = 0; i < record.varCount && i < 32; i++) {
+        declared[i] = (record.declaredMask >> i) & 1u;
+    }
+
+    for (uint64_t i = 0; i < record.eventCount; i++) {
+        LogEvent event = events[i];
+        event.messageId = remap(event.messageId);
+        outputLog.Append(event);
+    }
+
+    state = static_cast<ProcessState>(record.state);
+    backend = static_cast<ExecBackend>(record.backend);
+    currentLine = record.currentLine;
+    quietEnd = 0;
+    totalLines = record.totalLines;
+    windowStart = record.windowStart;
+    lazyWindow = record.lazyWindow;
+    loopIteration = record.loopIteration;
+    loopIndex = record.loopIndex;
+    coreAssigned = record.coreAssigned;
+    waitCycles = record.waitCycles;
+    executionTime = record.executionTime;
+    delayCounter = record.delayCounter;
+    priority = record.priority;
+    policyLevel = record.policyLevel;
+    levelEpoch = record.levelEpoch;
+    finishTick = record.finishTick;
+    coreHistory.assign(cores, cores + record.coreCount);
+    finishTime = static_cast<time_t>(record.finishTime);
+
+    instructions.clear();
+    if (backend == BACKEND_OBJECTS) {
+        BuildInstructions();
+    }
+}
+
+/* Moves what outlives a finished process into retired: identity, length,
+   finish time, core history and the log, which is pushed out to the spill
+   files. The process is destroyed right after. */
+void Process::Retire(RetiredProcess& retired) {
+    retired.name = name;
+    retired.pid = pid;
+    retired.totalLines = totalLines;
+    retired.finishTime = finishTime;
+    retired.coreHistory.assign(coreHistory.begin(), coreHistory.end());
+    outputLog.Release(retired.log);
 }
 
-/* Destructor to free dynamically allocated instruction memory.
+/* Notes that the process was dispatched to core. Each core is listed once,
+   in the order the process first ran there. */
+void Process::RecordCore(int core) {
+    if (core < 0) return;
+    if (!coreHistory.empty() && coreHistory.back() == core) return;
+
+    uint16_t id = static_cast<uint16_t>(core);
+    for (uint16_t used : coreHistory) {
+        if (used == id) return;
+    }
+    coreHistory.push_back(id);
+}
+
+/* Builds the heap-allocated Instruction objects from the bytecode.
+   Only used by the object backend, kept to compare against the interpreter. */
+void Process::BuildInstructions() {
+    instructions.reserve(program.ops.size());
+    for (const auto& op : program.ops) {
+        instructions.push_back(LowerOp(op));
+    }
+}
+
+/* Turns one encoded op back into its Instruction class, allocated in the arena. */
+Instruction* Process::LowerOp(const Op& op) {
+    switch (op.code) {
+    case OP_PRINT:
+        return arena->New<PrintInstruction>(op.imm, this);
+    case OP_DECLARE:
+        return arena->New<DeclareInstruction>(op.a, static_cast<uint16_t>(op.imm), this);
+    case OP_ADD:
+        return arena->New<AddInstruction>(op.a, op.b, static_cast<uint16_t>(op.imm), this);
+    case OP_SUBTRACT:
+        return arena->New<SubtractInstruction>(op.a, op.b, static_cast<uint16_t>(op.imm), this);
+    case OP_SLEEP:
+        return arena->New<SleepInstruction>(static_cast<uint8_t>(op.imm), this);
+    default: {
+        Instruction** loopBody = static_cast<Instruction**>(arena->Allocate(sizeof(Instruction*) * op.a, alignof(Instruction*)));
+        for (int j = 0; j < op.a; j++) {
+            loopBody[j] = LowerOp(program.loopBodies[op.imm + j]);
+        }
+        return arena->New<ForLoopInstruction>(loopBody, op.a, op.b, this);
+    }
+    }
+}
+
+/* Destructor. Instructions and ops live in the arena and are not freed one by
+   one: ProcessPool::Destroy() resets the arena after this runs, or the
+   process frees its own arena here if it created one.
    Connects with Schedulers destructor to ensure proper cleanup. */
 Process::~Process() {
-    for (auto instr : instructions) {
-        delete instr;
+    if (ownsArena) {
+        delete arena;
     }
 }
 
@@ -82,12 +264,84 @@ Process::~Process() {
    Called by Scheduler::Tick() whenever the process is assigned to a core.
    Handles waiting, delays, and transitions to FINISHED state. */
 void Process::Execute(int coreId) {
+    stampTick = SimClock::GetTick();
+    Step(coreId);
+}
+
+/* Runs up to maxSteps ticks of this process back to back, exactly as that
+   many Execute() calls on consecutive ticks from the current one would, and
+   says why it stopped. Delay ticks are used up in one step. Each line logs
+   the tick it stands for, so slicing across worker threads needs no shared
+   clock. Used by Scheduler::RunSlice(). */
+SliceResult Process::ExecuteSlice(int coreId, int maxSteps) {
+    SliceResult result;
+    result.reason = SLICE_QUANTUM;
+    result.steps = 0;
+
+    unsigned long long firstTick = SimClock::GetTick();
+    while (result.steps < maxSteps) {
+        if (state == RUNNING && delayCounter > 0) {
+            int burn = min(delayCounter, maxSteps - result.steps);
+            delayCounter -= burn;
+            executionTime += burn;
+            result.steps += burn;
+            continue;
+        }
+
+        stampTick = firstTick + result.steps;
+        Step(coreId);
+        executionTime++;
+        result.steps++;
+
+        if (state == WAITING) {
+            result.reason = SLICE_SLEPT;
+            break;
+        }
+        if (state == FINISHED) {
+            result.reason = SLICE_FINISHED;
+            break;
+        }
+    }
+    return result;
+}
+
+/* Counts the ticks, up to limit and starting with the next, in which this
+   process neither sleeps nor finishes. Reads ahead in the program without
+   running it, so it stops at the end of a lazy window whose next lines are
+   not generated yet. A FOR line counts as the body op it runs. The line
+   found is kept until the process reaches it, so repeated calls while it
+   runs toward it cost nothing. */
+int Process::CountQuietSteps(int limit) const {
+    if (state != RUNNING || currentLine >= totalLines) return 0;
+
+    if (quietEnd <= currentLine) {
+        int line = currentLine;
+        while (line < totalLines - 1) {
+            int index = line - windowStart;
+            if (index >= static_cast<int>(program.ops.size())) break;
+
+            Op op = program.ops[index];
+            while (op.code == OP_FOR && op.a > 0 && op.b > 0) {
+                op = program.loopBodies[op.imm];
+            }
+            if (op.code == OP_SLEEP) break;
+            line++;
+        }
+        quietEnd = line;
+    }
+
+    long long steps = delayCounter + static_cast<long long>(quietEnd - currentLine) * (1 + delaysPerExec);
+    return static_cast<int>(min(steps, static_cast<long long>(limit)));
+}
+
+/* One tick of Execute(), stamped with stampTick. */
+void Process::Step(int coreId) {
     if (state == FINISHED || currentLine >= totalLines) {
         state = FINISHED;
         
         // Record the exact time of completion if not already set
         if (finishTime == 0) {
-            finishTime = time(nullptr);
+            finishTime = SimClock::TimeAt(stampTick);
         }
     }
 
@@ -106,15 +360,81 @@ void Process::Execute(int coreId) {
 
     if (currentLine < totalLines) {
         coreAssigned = coreId; // temp
-        instructions[currentLine]->Execute();
+        if (backend == BACKEND_BYTECODE) {
+            if (currentLine - windowStart >= static_cast<int>(program.ops.size())) {
+                GenerateWindow();
+            }
+            ExecuteOp(program.ops[currentLine - windowStart]);
+        } else {
+            instructions[currentLine]->Execute();
+        }
         currentLine++;
 
+        // FOR progress belongs to the line that just retired
+        loopIteration = 0;
+        loopIndex = 0;
+
         if (currentLine >= totalLines) {
             state = FINISHED;
+        } else {
+            // delay-per-exec: the process keeps its core, busy-waiting, before the next line
+            delayCounter = delaysPerExec;
         }
     }
 }
 
+/* Bytecode interpreter: executes one encoded op against this process.
+   A single switch over a flat op array replaces the virtual call per
+   instruction; FOR keeps its iteration state in the process instead of in
+   the op so the program itself stays read-only. */
+void Process::ExecuteOp(const Op& op) {
+    switch (op.code) {
+    case OP_PRINT:
+        LogPrint(op.imm);
+        break;
+
+    case OP_DECLARE:
+        SetVariable(op.a, static_cast<uint16_t>(op.imm));
+        break;
+
+    case OP_ADD: {
+        uint32_t result = static_cast<uint32_t>(GetVariable(op.b)) + op.imm;
+        if (result > UINT16_MAX) {
+            result = UINT16_MAX;
+        }
+        SetVariable(op.a, static_cast<uint16_t>(result));
+        break;
+    }
+
+    case OP_SUBTRACT: {
+        int32_t result = static_cast<int32_t>(GetVariable(op.b)) - static_cast<int32_t>(op.imm);
+        if (result < 0) {
+            result = 0;
+        }
+        SetVariable(op.a, static_cast<uint16_t>(result));
+        break;
+    }
+
+    case OP_SLEEP:
+        waitCycles = static_cast<int>(op.imm);
+        state = WAITING;
+        break;
+
+    case OP_FOR:
+        // Same stepping as ForLoopInstruction::Execute(): one body op per call
+        if (loopIteration < op.b && loopIndex < op.a) {
+            ExecuteOp(program.loopBodies[op.imm + loopIndex]);
+            loopIndex++;
+
+            if (loopIndex >= op.a) {
+                loopIndex = 0;
+                loopIteration++;
+            }
+        }
+        break;
+    }
+}
+
 /* Checks whether the process has completed all instructions.
    Used by Scheduler to determine if the process should be rescheduled. */
 bool Process::IsFinished() const {
@@ -125,38 +445,116 @@ bool Process::IsFinished() const {
    Called when the user runs "process-smi" inside a screen.
    Connects Console::DisplayProcessScreen() to process-level data. */
 void Process::PrintInfo() const {
-    cout << "\nProcess name: " << name << endl;
-    cout << "ID: " << pid << endl;
-    
+    PrintDetail(GetDetail());
+}
+
+/* Copies the fields shown by screen -ls and report-util.
+   Used by Scheduler::PublishSnapshot(). */
+ProcessSummary Process::GetSummary() const {
+    ProcessSummary summary;
+    summary.name = name;
+    summary.pid = pid;
+    summary.state = state;
+    summary.currentLine = currentLine;
+    summary.totalLines = totalLines;
+    summary.coreAssigned = coreAssigned;
+    summary.finishTime = finishTime;
+    return summary;
+}
+
+/* Copies the summary plus the log's ring and spill chain head. Runs on the
+   tick thread; reading the spilled events back and formatting them is left
+   to PrintDetail() on the console thread. */
+ProcessDetail Process::GetDetail() const {
+    ProcessDetail detail;
+    detail.summary = GetSummary();
+    outputLog.Capture(detail.log);
+    detail.spill = outputLog.GetSpill();
+    detail.coreHistory = coreHistory;
+    return detail;
+}
+
+/* Prints a process copy made by GetDetail(). Called for "process-smi". */
+void Process::PrintDetail(const ProcessDetail& detail) {
+    const ProcessSummary& summary = detail.summary;
+    string processName = summary.name.ToString();
+    cout << "\nProcess name: " << processName << endl;
+    cout << "ID: " << summary.pid << endl;
+
+    vector<LogEvent> events;
+    CollectLogEvents(detail.log, detail.spill, events);
     cout << "Logs:" << endl;
-    for (const auto& log : outputLog) {
-        cout << log << endl;
+    for (const auto& event : events) {
+        cout << FormatLogEvent(event, processName) << endl;
+    }
+    if (detail.log.droppedCount > 0) {
+        cout << "(" << detail.log.droppedCount << " older entries dropped)" << endl;
+    }
+
+    if (!detail.coreHistory.empty()) {
+        cout << "\nCores used:";
+        for (uint16_t core : detail.coreHistory) {
+            cout << " " << core;
+        }
+        cout << endl;
     }
 
-    if (state == FINISHED) {
+    if (summary.state == FINISHED) {
         cout << "\nFinished!" << endl;
     } else {
-        cout << "\nCurrent instruction line: " << currentLine << endl;
-        cout << "Lines of code: " << totalLines << endl;
+        cout << "\nCurrent instruction line: " << summary.currentLine << endl;
+        cout << "Lines of code: " << summary.totalLines << endl;
     }
 }
 
-/* Adds a log entry (usually from a PRINT instruction) to the process output.
-   Connects Instruction classes (e.g., PrintInstruction) to this process. */
-void Process::AddOutput(const string& output) {
-    outputLog.push_back(output);
+/* Records a PRINT as a fixed-size event: no formatting or string work here.
+   Shared by PrintInstruction and the bytecode interpreter. */
+void Process::LogPrint(uint32_t messageId) {
+    LogEvent event = {};
+    event.wallTime = static_cast<int64_t>(SimClock::TimeAt(stampTick));
+    event.tick = static_cast<uint32_t>(stampTick);
+    event.messageId = messageId;
+    event.core = static_cast<int16_t>(coreAssigned);
+    outputLog.Append(event);
 }
 
-/* Retrieves a variables current value. Automatically initializes it to 0 if missing.
-   Used by ADD/SUBTRACT instructions for arithmetic operations. */
-uint16_t Process::GetVariable(const string& varName) {
-    if (variables.find(varName) == variables.end()) {
-        variables[varName] = 0;
+/* Formats the retained log entries, oldest first. Only called when someone
+   looks at the log (process-smi, report-util). */
+vector<string> Process::GetOutputLog() const {
+    vector<LogEvent> events;
+    outputLog.Collect(events);
+
+    string processName = GetName();
+    vector<string> lines;
+    lines.reserve(events.size());
+    for (const auto& event : events) {
+        lines.push_back(FormatLogEvent(event, processName));
     }
-    return variables[varName];
+    return lines;
+}
+
+/* Retrieves a variables current value. Automatically initializes it to 0 if missing.
+   Used by ADD/SUBTRACT instructions for arithmetic operations.
+   Slots come from Program::ResolveSymbol() at generation time. */
+uint16_t Process::GetVariable(uint8_t slot) {
+    declared[slot] = true;
+    return variables[slot];
 }
 
 /* Assigns a value to a process variable. */
-void Process::SetVariable(const string& varName, uint16_t value) {
-    variables[varName] = value;
+void Process::SetVariable(uint8_t slot, uint16_t value) {
+    variables[slot] = value;
+    declared[slot] = true;
+}
+
+/* Returns the declared variables by name, using the program's symbol table.
+   For display only; execution works on slots. */
+map<string, uint16_t> Process::GetVariables() const {
+    map<string, uint16_t> named;
+    for (size_t i = 0; i < variables.size(); i++) {
+        if (declared[i]) {
+            named[program.symbols[i]] = variables[i];
+        }
+    }
+    return named;
 }
\ No newline at end of file
@@ -6,41 +6,118 @@
 #include <map>
 #include <cstdint>
 #include "instruction.h"
+#include "processname.h"
+#include "bytecode.h"
+#include "arena.h"
+#include "outputlog.h"
+#include "checkpoint.h"
+#include "snapshot.h"
+#include "processlist.h"
 
 using namespace std;
 
-enum ProcessState {
-    READY,
-    RUNNING,
-    WAITING,
-    FINISHED
+enum ExecBackend {
+    BACKEND_BYTECODE,
+    BACKEND_OBJECTS
+};
+
+struct ProgramOptions {
+    ExecBackend backend = BACKEND_BYTECODE;
+    int lazyWindow = 0;     // lines generated per window, 0 = whole program up front
+    int logCapacity = 64;   // PRINT events kept in memory per process
+    LogSpill* logSpill = nullptr;   // where older events go; null = drop them
+    uint64_t seed = 0;      // master seed; each process derives its own from it and its PID
+    bool optimize = true;   // run Program::Optimize() on every generated program or window
+};
+
+/* Why Process::ExecuteSlice() stopped. */
+enum SliceStop {
+    SLICE_QUANTUM,      // ran every step it was given
+    SLICE_SLEPT,        // ran SLEEP and left the core
+    SLICE_FINISHED
+};
+
+struct SliceResult {
+    SliceStop reason;
+    int steps;          // ticks used, including the one that slept or finished
+};
+
+/* What is kept of a finished process once it is retired (see
+   Scheduler::RetireFinished()): enough for screen -ls, report-util and
+   process-smi. The log itself stays in the spill files. */
+struct RetiredProcess {
+    ProcessName name;
+    int pid;
+    int totalLines;
+    time_t finishTime;
+    vector<uint16_t> coreHistory;
+    LogReference log;
 };
 
 class Process {
 private:
-    string name;
+    ProcessName name;
     int pid;
     ProcessState state;
     int currentLine;
     int totalLines;
-    vector<Instruction*> instructions;
-    map<string, uint16_t> variables;
-    vector<string> outputLog;
+    ExecBackend backend;
+    Arena* arena;
+    bool ownsArena;
+    Program program;
+    ProgramGenerator generator;
+    uint64_t seed;
+    int windowStart;
+    int lazyWindow;
+    bool optimize;
+    int loopIteration;
+    int loopIndex;
+    vector<Instruction*, ArenaAllocator<Instruction*>> instructions;
+    vector<uint16_t> variables;
+    vector<bool> declared;
+    OutputLog outputLog;
     int coreAssigned;
     int waitCycles;
     int executionTime;
-    int delayCounter;
+    int delayCounter;   // busy-wait ticks left before the next instruction
+    int delaysPerExec;
+    int priority;       // static priority, smaller runs first (PRIORITY policy)
+    int policyLevel;    // current MLFQ level
+    int levelEpoch;     // MLFQ boost epoch policyLevel was set in
+    int finishTick;
+    vector<uint16_t> coreHistory;   // cores the process was dispatched to, in first-use order
     time_t finishTime;
+    unsigned long long stampTick;   // tick the running step stands for, used by LogPrint()
+    mutable int quietEnd;           // first line from currentLine on that sleeps, finishes or ends the window
+    ProcessLink stateLink;
+
+    void GenerateWindow();
+    void BuildInstructions();
+    Instruction* LowerOp(const Op& op);
+    void ExecuteOp(const Op& op);
+    void Step(int coreId);
 
 public:
-    Process(string processName, int processId, int numInstructions, int delaysPerExec);
+    Process(const ProcessName& processName, int processId, int numInstructions, int delaysPerExec,
+        const ProgramOptions& options = ProgramOptions(), Arena* memory = nullptr);
     ~Process();
 
+    void LoadProgram(const vector<Op>& ops, const vector<Op>& loopBodies);
+    void SaveState(ProcessRecord& record, vector<uint16_t>& vars, vector<uint16_t>& cores) const;
+    void RestoreState(const ProcessRecord& record, const Op* ops, const uint16_t* vars,
+        const uint16_t* cores, const LogEvent* events, const vector<uint32_t>& messageMap);
+    void Retire(RetiredProcess& retired);
     void Execute(int coreId);
+    SliceResult ExecuteSlice(int coreId, int maxSteps);
+    int CountQuietSteps(int limit) const;
     bool IsFinished() const;
     void PrintInfo() const;
+    ProcessSummary GetSummary() const;
+    ProcessDetail GetDetail() const;
+    static void PrintDetail(const ProcessDetail& detail);
 
-    string GetName() const { return name; }
+    string GetName() const { return name.ToString(); }
+    const ProcessName& GetProcessName() const { return name; }
     int GetPID() const { return pid; }
     ProcessState GetState() const { return state; }
     void SetState(ProcessState newState) { state = newState; }
@@ -49,15 +126,39 @@ public:
     int GetCoreAssigned() const { return coreAssigned; }
     void SetCoreAssigned(int core) { coreAssigned = core; }
     int GetWaitCycles() const { return waitCycles; }
+    void SetWaitCycles(int cycles) { waitCycles = cycles; }
     void DecrementWait() { if (waitCycles > 0) waitCycles--; }
     int GetExecutionTime() const { return executionTime; }
     void IncrementExecutionTime() { executionTime++; }
+    int GetDelayCounter() const { return delayCounter; }
+    void SkipDelay(int ticks) { delayCounter -= ticks; executionTime += ticks; }
+    int GetPriority() const { return priority; }
+    void SetPriority(int value) { priority = value; }
+    int GetPolicyLevel() const { return policyLevel; }
+    int GetLevelEpoch() const { return levelEpoch; }
+    void SetPolicyLevel(int level, int epoch) { policyLevel = level; levelEpoch = epoch; }
+
+    ExecBackend GetBackend() const { return backend; }
+    const Program& GetProgram() const { return program; }
+    uint64_t GetSeed() const { return seed; }
+    bool IsLazy() const { return lazyWindow > 0; }
+    Arena* GetArena() const { return arena; }
+
+    void LogPrint(uint32_t messageId);
+    vector<string> GetOutputLog() const;
+    uint64_t GetOutputCount() const { return outputLog.Size(); }
+    const OutputLog& GetLog() const { return outputLog; }
+
+    uint16_t GetVariable(uint8_t slot);
+    void SetVariable(uint8_t slot, uint16_t value);
+    map<string, uint16_t> GetVariables() const;
 
-    void AddOutput(const string& output);
-    vector<string> GetOutputLog() const { return outputLog; }
+    ProcessLink& GetStateLink() { return stateLink; }
 
-    uint16_t GetVariable(const string& varName);
-    void SetVariable(const string& varName, uint16_t value);
+    void RecordCore(int core);
+    const vector<uint16_t>& GetCoreHistory() const { return coreHistory; }
+    int GetFinishTick() const { return finishTick; }
+    void SetFinishTick(int tick) { finishTick = tick; }
 
     void SetFinishTime(time_t t) { finishTime = t; }
     time_t GetFinishTime() const { return finishTime; }
@@ -0,0 +1,57 @@
+/* Intrusive process lists used to keep processes grouped by state */
+
+#include "processlist.h"
+#include "process.h"
+
+using namespace std;
+
+/* Constructor: an empty list. */
+ProcessList::ProcessList(int listId) : id(listId), head(nullptr), tail(nullptr), count(0) {}
+
+/* Appends a process that is not on any list. */
+void ProcessList::PushBack(Process* proc) {
+    ProcessLink& link = proc->GetStateLink();
+    link.prev = tail;
+    link.next = nullptr;
+    link.list = id;
+
+    if (tail != nullptr) {
+        tail->GetStateLink().next = proc;
+    } else {
+        head = proc;
+    }
+    tail = proc;
+    count++;
+}
+
+/* Unlinks a process from this list. */
+void ProcessList::Remove(Process* proc) {
+    ProcessLink& link = proc->GetStateLink();
+    if (link.list != id) return;
+
+    if (link.prev != nullptr) link.prev->GetStateLink().next = link.next;
+    else head = link.next;
+    if (link.next != nullptr) link.next->GetStateLink().prev = link.prev;
+    else tail = link.prev;
+
+    link.prev = nullptr;
+    link.next = nullptr;
+    link.list = -1;
+    count--;
+}
+
+/* Forgets every process without touching them. Used when the processes
+   themselves are about to be destroyed. */
+void ProcessList::Clear() {
+    head = nullptr;
+    tail = nullptr;
+    count = 0;
+}
+
+/* Appends every process on the list to out, front to back. */
+void ProcessList::Collect(vector<Process*>& out) const {
+    out.reserve(out.size() + count);
+    for (Process* proc = head; proc != nullptr; proc = proc->GetStateLink().next) {
+        out.push_back(proc);
+    }
+}
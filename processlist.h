@@ -0,0 +1,44 @@
+#ifndef PROCESSLIST_H
+#define PROCESSLIST_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+class Process;
+
+/* Links a process into at most one ProcessList. Lives inside Process, so
+   moving a process between lists never allocates. */
+struct ProcessLink {
+    Process* prev = nullptr;
+    Process* next = nullptr;
+    int list = -1;      // id of the list holding the process, -1 = none
+};
+
+/* Intrusive doubly linked list of processes. Push and remove are O(1), and
+   the list keeps its own count so Size() never walks it. */
+class ProcessList {
+private:
+    int id;
+    Process* head;
+    Process* tail;
+    size_t count;
+
+public:
+    explicit ProcessList(int listId = -1);
+
+    void SetId(int listId) { id = listId; }
+    int GetId() const { return id; }
+
+    void PushBack(Process* proc);
+    void Remove(Process* proc);
+    void Clear();
+    void Collect(vector<Process*>& out) const;
+
+    Process* Front() const { return head; }
+    size_t Size() const { return count; }
+    bool Empty() const { return count == 0; }
+};
+
+#endif
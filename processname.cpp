@@ -0,0 +1,114 @@
+/* Interned, compact storage for process names */
+
+#include <unordered_set>
+#include <mutex>
+#include <functional>
+#include <cctype>
+#include "processname.h"
+
+using namespace std;
+
+/* Global intern pool. Node-based, so the string addresses handed out stay valid
+   for the lifetime of the program. Guarded because names can be built from the
+   console thread and the tick thread. */
+static unordered_set<string>& InternPool() {
+    static unordered_set<string> pool;
+    return pool;
+}
+
+static mutex& InternLock() {
+    static mutex lock;
+    return lock;
+}
+
+static const string* Intern(const string& text) {
+    lock_guard<mutex> guard(InternLock());
+    return &*InternPool().insert(text).first;
+}
+
+/* Default constructor: an empty name that matches nothing. */
+ProcessName::ProcessName() : text(nullptr), number(-1) {}
+
+/* Builds a name from user input (e.g. screen -s). Uses the same split as
+   Numbered(), so "process7" typed by hand equals the generated process7. */
+ProcessName::ProcessName(const string& name) : text(nullptr), number(-1) {
+    string prefix;
+    int64_t suffix;
+    if (Split(name, prefix, suffix)) {
+        text = Intern(prefix);
+        number = suffix;
+    } else {
+        text = Intern(name);
+    }
+}
+
+/* Builds prefix + suffix without formatting a string.
+   Used by Scheduler::Tick() for the auto-generated "process<N>" names. */
+ProcessName ProcessName::Numbered(const string& prefix, int64_t suffix) {
+    return ProcessName(Intern(prefix), suffix);
+}
+
+/* Looks up an existing name without adding anything to the intern pool.
+   Returns false when no process could have this name. */
+bool ProcessName::Find(const string& name, ProcessName& out) {
+    string prefix;
+    int64_t suffix = -1;
+    const string& key = Split(name, prefix, suffix) ? prefix : name;
+
+    lock_guard<mutex> guard(InternLock());
+    auto it = InternPool().find(key);
+    if (it == InternPool().end()) return false;
+
+    out = ProcessName(&*it, suffix);
+    return true;
+}
+
+/* Splits "name123" into "name" and 123. Only canonical numbers are split
+   (no leading zeros, at most 18 digits) so that ToString() gives back the
+   exact input. */
+bool ProcessName::Split(const string& name, string& prefix, int64_t& suffix) {
+    size_t digits = 0;
+    while (digits < name.size() && isdigit(static_cast<unsigned char>(name[name.size() - 1 - digits]))) {
+        digits++;
+    }
+    if (digits == 0 || digits > 18) return false;
+
+    size_t start = name.size() - digits;
+    if (name[start] == '0' && digits > 1) return false;
+
+    prefix = name.substr(0, start);
+    suffix = stoll(name.substr(start));
+    return true;
+}
+
+/* Formats the full name. Only called for display. */
+string ProcessName::ToString() const {
+    if (text == nullptr) return string();
+    if (number < 0) return *text;
+    return *text + to_string(number);
+}
+
+/* Appends the full name to out without building a temporary string.
+   Used by the report writer, which prints every process name. */
+void ProcessName::AppendTo(string& out) const {
+    if (text == nullptr) return;
+    out += *text;
+    if (number < 0) return;
+
+    char digits[20];
+    int length = 0;
+    int64_t value = number;
+    do {
+        digits[length++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (length > 0) {
+        out += digits[--length];
+    }
+}
+
+/* Hash over the interned pointer and the number; no string hashing needed. */
+size_t ProcessName::Hash() const {
+    size_t h = hash<const void*>()(text);
+    return h ^ (hash<int64_t>()(number) + static_cast<size_t>(0x9e3779b97f4a7c15ULL) + (h << 6) + (h >> 2));
+}
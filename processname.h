@@ -0,0 +1,44 @@
+#ifndef PROCESSNAME_H
+#define PROCESSNAME_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/* Compact process name. The text part is interned once for the whole program,
+   and a trailing decimal number is kept as an integer, so "process1" ..
+   "process1000000" all share one "process" string. */
+class ProcessName {
+private:
+    const string* text;
+    int64_t number;
+
+    ProcessName(const string* internedText, int64_t suffix) : text(internedText), number(suffix) {}
+    static bool Split(const string& name, string& prefix, int64_t& suffix);
+
+public:
+    ProcessName();
+    explicit ProcessName(const string& name);
+
+    static ProcessName Numbered(const string& prefix, int64_t suffix);
+    static bool Find(const string& name, ProcessName& out);
+
+    string ToString() const;
+    void AppendTo(string& out) const;
+    bool IsEmpty() const { return text == nullptr; }
+
+    bool operator==(const ProcessName& other) const {
+        return text == other.text && number == other.number;
+    }
+    bool operator!=(const ProcessName& other) const { return !(*this == other); }
+
+    size_t Hash() const;
+};
+
+struct ProcessNameHash {
+    size_t operator()(const ProcessName& name) const { return name.Hash(); }
+};
+
+#endif
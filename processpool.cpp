@@ -0,0 +1,79 @@
+/* Slab storage and free list for Process objects */
+
+#include "processpool.h"
+
+using namespace std;
+
+/* Constructor starts empty; slabs are added on demand. */
+ProcessPool::ProcessPool() : liveCount(0) {}
+
+/* Destructor frees slabs and pooled arenas. Every process must have been
+   passed to Destroy() first (Scheduler::~Scheduler() does this). */
+ProcessPool::~ProcessPool() {
+    for (auto arena : freeArenas) {
+        delete arena;
+    }
+    for (auto slab : slabs) {
+        ::operator delete(slab);
+    }
+}
+
+/* Allocates storage for SLAB_SIZE more processes and puts it on the free list. */
+void ProcessPool::AddSlab() {
+    char* slab = static_cast<char*>(::operator new(SLAB_SIZE * sizeof(Process)));
+    slabs.push_back(slab);
+    for (size_t i = SLAB_SIZE; i > 0; i--) {
+        freeSlots.push_back(slab + (i - 1) * sizeof(Process));
+    }
+}
+
+/* Builds a process in recycled storage with a recycled arena.
+   The free lists are locked only while taking a slot; instruction
+   generation runs outside the lock. */
+Process* ProcessPool::Create(const ProcessName& name, int pid, int numInstructions, int delaysPerExec, const ProgramOptions& options) {
+    void* slot;
+    Arena* arena;
+    {
+        lock_guard<mutex> guard(lock);
+        if (freeSlots.empty()) {
+            AddSlab();
+        }
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+
+        if (freeArenas.empty()) {
+            arena = new Arena();
+        } else {
+            arena = freeArenas.back();
+            freeArenas.pop_back();
+        }
+        liveCount++;
+    }
+
+    try {
+        return new (slot) Process(name, pid, numInstructions, delaysPerExec, options, arena);
+    }
+    catch (...) {
+        arena->Reset();
+        lock_guard<mutex> guard(lock);
+        freeSlots.push_back(slot);
+        freeArenas.push_back(arena);
+        liveCount--;
+        throw;
+    }
+}
+
+/* Destroys a process, releases its whole arena in one go and keeps both
+   the storage and the arena for reuse. */
+void ProcessPool::Destroy(Process* proc) {
+    if (proc == nullptr) return;
+
+    Arena* arena = proc->GetArena();
+    proc->~Process();
+    arena->Reset();
+
+    lock_guard<mutex> guard(lock);
+    freeSlots.push_back(proc);
+    freeArenas.push_back(arena);
+    liveCount--;
+}
@@ -0,0 +1,40 @@
+#ifndef PROCESSPOOL_H
+#define PROCESSPOOL_H
+
+#include <vector>
+#include <mutex>
+#include "process.h"
+#include "arena.h"
+
+using namespace std;
+
+/* Recycles Process objects and their arenas. Process storage comes from
+   slabs of SLAB_SIZE objects, and destroyed processes go onto a free list
+   together with their (reset) arena for the next CreateNewProcess(). */
+class ProcessPool {
+private:
+    static const size_t SLAB_SIZE = 256;
+
+    mutex lock;
+    vector<char*> slabs;
+    vector<void*> freeSlots;
+    vector<Arena*> freeArenas;
+    size_t liveCount;
+
+    void AddSlab();
+
+public:
+    ProcessPool();
+    ~ProcessPool();
+
+    ProcessPool(const ProcessPool&) = delete;
+    ProcessPool& operator=(const ProcessPool&) = delete;
+
+    Process* Create(const ProcessName& name, int pid, int numInstructions, int delaysPerExec, const ProgramOptions& options);
+    void Destroy(Process* proc);
+
+    size_t GetLiveCount() const { return liveCount; }
+    size_t GetFreeCount() const { return freeSlots.size(); }
+};
+
+#endif
@@ -0,0 +1,163 @@
+/* Background generation of processes for scheduler-start */
+
+#include "producer.h"
+
+using namespace std;
+
+/* Constructor creates a producer without threads (inline generation). */
+ProcessProducer::ProcessProducer() : pool(nullptr), delaysPerExec(0), stopping(false), submitted(0), taken(0) {}
+
+/* Destructor stops the threads and frees processes nobody took. */
+ProcessProducer::~ProcessProducer() {
+    Shutdown();
+}
+
+/* Spawns one lane per thread. capacity is how many orders the scheduler
+   normally keeps outstanding; more are held back until a lane has room. */
+void ProcessProducer::Start(int threads, size_t capacity, ProcessPool* processPool, int delays,
+    const ProgramOptions& programOptions) {
+    Shutdown();
+
+    pool = processPool;
+    options = programOptions;
+    delaysPerExec = delays;
+    stopping = false;
+    submitted = 0;
+    taken = 0;
+
+    if (threads <= 0) return;
+    size_t perLane = capacity / threads + 1;
+    for (int i = 0; i < threads; i++) {
+        lanes.emplace_back(new Lane());
+        lanes.back()->orders.Reset(perLane);
+        lanes.back()->built.Reset(perLane);
+    }
+    for (auto& lane : lanes) {
+        lane->worker = thread(&ProcessProducer::WorkerLoop, this, ref(*lane));
+    }
+}
+
+/* Stops every lane and destroys the processes that were built but never
+   taken. Outstanding and held orders are dropped; the scheduler still has them. */
+void ProcessProducer::Shutdown() {
+    stopping = true;
+    for (auto& lane : lanes) {
+        {
+            lock_guard<mutex> guard(lane->sleepLock);
+        }
+        lane->wake.notify_one();
+    }
+
+    for (auto& lane : lanes) {
+        if (lane->worker.joinable()) {
+            lane->worker.join();
+        }
+        Process* proc;
+        while (lane->built.Pop(proc)) {
+            pool->Destroy(proc);
+        }
+    }
+    lanes.clear();
+    held.clear();
+    submitted = 0;
+    taken = 0;
+}
+
+/* Queues an order for the producers. It goes straight to its lane unless
+   that lane already has a full ring's worth outstanding (the tick thread is
+   behind taking), in which case it waits in held until TryTake() frees room. */
+void ProcessProducer::Submit(const ProcessOrder& order) {
+    held.push_back(order);
+    Flush();
+}
+
+/* Moves held orders to their lanes, oldest first, until the next lane is
+   full. Lanes are strictly round-robin so TryTake() finds them in order.
+   Lock-free unless a lane's thread is asleep, which is woken under its lock. */
+void ProcessProducer::Flush() {
+    while (!held.empty()) {
+        Lane& lane = *lanes[submitted % lanes.size()];
+        // Counting outstanding rather than ring slots also bounds what the
+        // worker can have built, so its built ring never fills up either
+        if (lane.outstanding >= lane.orders.Capacity() || !lane.orders.Push(held.front())) {
+            return;
+        }
+        held.pop_front();
+        lane.outstanding++;
+        submitted++;
+
+        // Pairs with the fence in WorkerLoop(): either the worker sees the order
+        // or this side sees it idle and wakes it
+        atomic_thread_fence(memory_order_seq_cst);
+        if (lane.idle.load(memory_order_relaxed)) {
+            {
+                lock_guard<mutex> guard(lane.sleepLock);
+            }
+            lane.wake.notify_one();
+        }
+    }
+}
+
+/* Takes the next built process, in submission order, or returns nullptr
+   straight away when its producer has not finished it yet; the caller asks
+   again on a later tick. Never waits. */
+Process* ProcessProducer::TryTake() {
+    if (submitted == taken) return nullptr;
+
+    Lane& lane = *lanes[taken % lanes.size()];
+    Process* proc = nullptr;
+    if (!lane.built.Pop(proc)) return nullptr;
+
+    taken++;
+    lane.outstanding--;
+    Flush();
+    return proc;
+}
+
+/* Takes the next built process, yielding until its producer has finished
+   it. Only call with an order outstanding. */
+Process* ProcessProducer::Take() {
+    Process* proc = TryTake();
+    while (proc == nullptr) {
+        this_thread::yield();
+        proc = TryTake();
+    }
+    return proc;
+}
+
+/* Creates the process for one order: the program generation that used to
+   run inside the tick. Safe on any thread; the pool, name and message
+   tables lock internally. */
+Process* ProcessProducer::Build(const ProcessOrder& order) const {
+    ProcessName name = ProcessName::Numbered("process", order.sequence);
+    Process* proc = pool->Create(name, order.pid, order.numInstructions, delaysPerExec, options);
+    proc->SetPriority(order.priority);
+    return proc;
+}
+
+/* Lane body: builds orders as they arrive and sleeps when there are none. */
+void ProcessProducer::WorkerLoop(Lane& lane) {
+    while (!stopping) {
+        ProcessOrder order;
+        if (lane.orders.Pop(order)) {
+            // Flush() keeps at most a ring's worth outstanding per lane, so
+            // this only retries if that ever stops holding; the process is
+            // kept rather than dropped either way
+            Process* proc = Build(order);
+            while (!lane.built.Push(proc)) {
+                if (stopping) {
+                    pool->Destroy(proc);
+                    return;
+                }
+                this_thread::yield();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> guard(lane.sleepLock);
+        lane.idle.store(true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        lane.wake.wait(guard, [&] { return stopping.load() || !lane.orders.Empty(); });
+        lane.idle.store(false, memory_order_relaxed);
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef PRODUCER_H
+#define PRODUCER_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "process.h"
+#include "processpool.h"
+
+using namespace std;
+
+/* One generated process, decided on the tick thread: its name number, PID
+   and the random draws. Building the program is the expensive part and is
+   left to the producers. */
+struct ProcessOrder {
+    int64_t sequence;       // N in "processN"
+    int pid;
+    int numInstructions;
+    int priority;
+};
+
+/* Bounded single-producer/single-consumer ring. Push and Pop never block or
+   lock; each side only writes its own index, and the release/acquire pair
+   on the indexes hands the slot contents over. */
+template <typename T>
+class HandoffRing {
+private:
+    vector<T> slots;
+    size_t mask;
+    alignas(64) atomic<size_t> head;    // next slot to pop, written by the consumer
+    alignas(64) atomic<size_t> tail;    // next slot to push, written by the producer
+
+public:
+    HandoffRing() : mask(0), head(0), tail(0) {}
+
+    /* Rounds capacity up to a power of two. Only call while both sides are idle. */
+    void Reset(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.assign(size, T());
+        mask = size - 1;
+        head.store(0, memory_order_relaxed);
+        tail.store(0, memory_order_relaxed);
+    }
+
+    bool Push(const T& item) {
+        size_t t = tail.load(memory_order_relaxed);
+        if (t - head.load(memory_order_acquire) > mask) return false;
+        slots[t & mask] = item;
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& item) {
+        size_t h = head.load(memory_order_relaxed);
+        if (h == tail.load(memory_order_acquire)) return false;
+        item = slots[h & mask];
+        head.store(h + 1, memory_order_release);
+        return true;
+    }
+
+    bool Empty() const { return head.load(memory_order_acquire) == tail.load(memory_order_acquire); }
+    size_t Capacity() const { return mask + 1; }
+};
+
+/* Builds generated processes ahead of time on background threads so the
+   tick thread only links them in. Order i goes to lane i % lanes and comes
+   back on the same lane, so the tick thread takes them in order without any
+   shared queue. Orders that do not fit a lane yet are held back. TryTake()
+   never waits, so the interactive tick can take a process that is not built
+   yet on a later tick; Take() waits for it. With zero threads nothing runs
+   in the background and the scheduler calls Build() itself. */
+class ProcessProducer {
+private:
+    struct Lane {
+        HandoffRing<ProcessOrder> orders;
+        HandoffRing<Process*> built;
+        thread worker;
+        mutex sleepLock;
+        condition_variable wake;
+        atomic<bool> idle;
+        size_t outstanding;     // submitted to this lane and not taken yet (tick thread only)
+
+        Lane() : idle(false), outstanding(0) {}
+    };
+
+    vector<unique_ptr<Lane>> lanes;
+    ProcessPool* pool;
+    ProgramOptions options;
+    int delaysPerExec;
+    atomic<bool> stopping;
+    unsigned long long submitted;
+    unsigned long long taken;
+    deque<ProcessOrder> held;   // submitted while their lane was full, in order
+
+    void WorkerLoop(Lane& lane);
+    void Flush();
+
+public:
+    ProcessProducer();
+    ~ProcessProducer();
+
+    ProcessProducer(const ProcessProducer&) = delete;
+    ProcessProducer& operator=(const ProcessProducer&) = delete;
+
+    void Start(int threads, size_t capacity, ProcessPool* processPool, int delays, const ProgramOptions& programOptions);
+    void Shutdown();
+
+    void Submit(const ProcessOrder& order);
+    Process* TryTake();
+    Process* Take();
+    Process* Build(const ProcessOrder& order) const;
+
+    int GetThreadCount() const { return static_cast<int>(lanes.size()); }
+};
+
+#endif
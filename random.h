@@ -0,0 +1,75 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+using namespace std;
+
+/* One SplitMix64 step: advances x and returns a well-mixed 64-bit value.
+   Used to turn the master seed into unrelated per-process seeds. */
+inline uint64_t SplitMix64(uint64_t& x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    uint64_t z = x;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Independent streams drawn from one master seed and PID
+enum RandomStream {
+    STREAM_PROGRAM,     // the process's instructions
+    STREAM_WORKLOAD     // its length and priority, drawn by the scheduler
+};
+
+/* Seed for one stream of one process. Neighbouring PIDs and streams go
+   through SplitMix64, so they get unrelated sequences, and the result does
+   not depend on when or on which thread the process is generated. */
+inline uint64_t DeriveSeed(uint64_t master, uint64_t pid, RandomStream stream) {
+    uint64_t x = master;
+    SplitMix64(x);
+    x ^= pid * 0xd1b54a32d192ed03ULL;
+    x ^= static_cast<uint64_t>(stream) * 0x8cb92ba72f3d8dd7ULL;
+    return SplitMix64(x);
+}
+
+/* Small per-process random generator (PCG32, XSH-RR output, one fixed
+   stream). Unlike rand() it has no global state, so every process can
+   generate its program independently on any thread and resume generation
+   later from the saved 64-bit state. */
+class Random {
+private:
+    static const uint64_t MULTIPLIER = 6364136223846793005ULL;
+    static const uint64_t INCREMENT = 1442695040888963407ULL;
+
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed = 0) { Seed(seed); }
+
+    void Seed(uint64_t seed) {
+        state = 0;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    uint32_t Next() {
+        uint64_t old = state;
+        state = old * MULTIPLIER + INCREMENT;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+    }
+
+    /* Value in [0, bound) by multiply-shift instead of a division; the bias
+       is negligible for the small ranges used here. */
+    int NextInt(int bound) {
+        if (bound <= 0) return 0;
+        return static_cast<int>((static_cast<uint64_t>(Next()) * static_cast<uint32_t>(bound)) >> 32);
+    }
+
+    uint64_t GetState() const { return state; }
+    void SetState(uint64_t saved) { state = saved; }
+};
+
+#endif
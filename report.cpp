@@ -0,0 +1,387 @@
+/* Background utilization report writer: text, CSV and JSON output */
+
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include "report.h"
+#include "platform.h"
+
+using namespace std;
+
+/* Formats timestamps the way the console always has. */
+string FormatTimestamp(time_t t) {
+    char buf[64];
+    tm local_tm;
+    localtime_s(&local_tm, &t);
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S %p", &local_tm);
+    return string(buf);
+}
+
+/* Output buffer for one report. Lines are assembled in memory and written in
+   FLUSH_SIZE blocks, so a report with a million rows costs a few hundred
+   writes instead of one flush per line. */
+class ReportBuffer {
+private:
+    static const size_t FLUSH_SIZE = 1 << 20;
+
+    ofstream& out;
+    string data;
+    time_t cachedTime;
+    string cachedStamp;
+
+public:
+    explicit ReportBuffer(ofstream& file) : out(file), cachedTime(-1) {
+        data.reserve(FLUSH_SIZE + 4096);
+    }
+
+    ~ReportBuffer() { Flush(); }
+
+    void Put(const string& text) { data += text; }
+    void Put(const char* text) { data += text; }
+    void Put(char c) { data += c; }
+
+    void PutInt(long long value) {
+        char buf[24];
+        int length = snprintf(buf, sizeof(buf), "%lld", value);
+        data.append(buf, length);
+    }
+
+    void PutPercent(double value) {
+        char buf[32];
+        int length = snprintf(buf, sizeof(buf), "%.2f", value);
+        data.append(buf, length);
+    }
+
+    void PutName(const ProcessName& name) { name.AppendTo(data); }
+
+    // Finish times repeat a lot (many processes finish in the same second),
+    // so the last formatted one is reused
+    void PutTime(time_t t) {
+        if (t != cachedTime) {
+            cachedTime = t;
+            cachedStamp = FormatTimestamp(t);
+        }
+        data += cachedStamp;
+    }
+
+    void EndLine() {
+        data += '\n';
+        Check();
+    }
+
+    // Writes the buffer out once it is full; safe to call mid-line
+    void Check() {
+        if (data.size() >= FLUSH_SIZE) Flush();
+    }
+
+    void Flush() {
+        if (data.empty()) return;
+        out.write(data.data(), static_cast<streamsize>(data.size()));
+        data.clear();
+    }
+};
+
+static const char* StateName(ProcessState state) {
+    switch (state) {
+    case READY: return "ready";
+    case RUNNING: return "running";
+    case WAITING: return "waiting";
+    default: return "finished";
+    }
+}
+
+/* Calls visit for every finished summary after the first skip, in
+   completion order. Whole chunks are skipped without being touched. */
+template <typename Visit>
+static void ForEachFinished(const SchedulerSnapshot& snap, size_t skip, Visit visit) {
+    for (const auto& chunk : snap.finished) {
+        if (skip >= chunk->size()) {
+            skip -= chunk->size();
+            continue;
+        }
+        for (size_t i = skip; i < chunk->size(); i++) {
+            visit((*chunk)[i]);
+        }
+        skip = 0;
+    }
+}
+
+/* The classic report-util layout. An incremental append lists only the
+   processes finished since the previous report. */
+static void WriteText(ReportBuffer& out, const SchedulerSnapshot& snap, time_t now, size_t skip, bool appending) {
+    static const char* RULE = "-----------------------------------------------";
+
+    if (appending) {
+        out.EndLine();
+    }
+    out.Put("CPU Utilization: "); out.PutPercent(snap.cpuUtilization); out.Put('%'); out.EndLine();
+    out.Put("Cores used: "); out.PutInt(snap.coresUsed); out.EndLine();
+    out.Put("Cores available: "); out.PutInt(snap.numCPU - snap.coresUsed); out.EndLine();
+    out.Put(RULE); out.EndLine();
+    out.EndLine();
+
+    string ts = "(" + FormatTimestamp(now) + ")   ";
+
+    // Processes on a core show it; ready and sleeping ones show their state
+    out.Put("Unfinished processes:"); out.EndLine();
+    if (snap.UnfinishedCount() == 0) {
+        out.Put("None"); out.EndLine();
+    }
+    for (auto proc : snap.Unfinished()) {
+        out.PutName(proc->name); out.Put("   "); out.Put(ts);
+        if (proc->state == RUNNING) {
+            out.Put("Core: "); out.PutInt(proc->coreAssigned); out.Put("   ");
+        } else {
+            out.Put(proc->state == READY ? "Ready   " : "Waiting   ");
+        }
+        out.PutInt(proc->currentLine); out.Put('/'); out.PutInt(proc->totalLines);
+        out.EndLine();
+    }
+
+    out.EndLine();
+    out.Put(appending ? "Finished since last report:" : "Finished processes:"); out.EndLine();
+    if (snap.finishedCount <= skip) {
+        out.Put("None"); out.EndLine();
+    }
+    // Listed in completion order
+    ForEachFinished(snap, skip, [&](const ProcessSummary& proc) {
+        out.PutName(proc.name); out.Put("   "); out.Put(ts);
+        out.Put("Finished   "); out.PutInt(proc.totalLines); out.Put('/'); out.PutInt(proc.totalLines);
+        out.EndLine();
+    });
+
+    out.Put(RULE); out.EndLine();
+}
+
+/* Puts a name as one CSV field, quoted only when it has to be. */
+static void PutCsvName(ReportBuffer& out, const ProcessName& name) {
+    string text = name.ToString();
+    if (text.find_first_of(",\"\n") == string::npos) {
+        out.Put(text);
+        return;
+    }
+    out.Put('"');
+    for (char c : text) {
+        if (c == '"') out.Put('"');
+        out.Put(c);
+    }
+    out.Put('"');
+}
+
+static void PutCsvRow(ReportBuffer& out, int tick, const ProcessSummary& proc) {
+    out.PutInt(tick); out.Put(',');
+    out.Put(proc.state == FINISHED ? "finished," : "unfinished,");
+    PutCsvName(out, proc.name); out.Put(',');
+    out.PutInt(proc.pid); out.Put(',');
+    out.Put(StateName(proc.state)); out.Put(',');
+    out.PutInt(proc.coreAssigned); out.Put(',');
+    out.PutInt(proc.currentLine); out.Put(',');
+    out.PutInt(proc.totalLines); out.Put(',');
+    if (proc.finishTime != 0) out.PutTime(proc.finishTime);
+    out.EndLine();
+}
+
+/* One row per process; the tick column tells appended reports apart. */
+static void WriteCsv(ReportBuffer& out, const SchedulerSnapshot& snap, size_t skip, bool appending) {
+    if (!appending) {
+        out.Put("tick,section,name,pid,state,core,current_line,total_lines,finish_time");
+        out.EndLine();
+    }
+    for (auto proc : snap.Unfinished()) {
+        PutCsvRow(out, snap.cpuTicks, *proc);
+    }
+    ForEachFinished(snap, skip, [&](const ProcessSummary& proc) {
+        PutCsvRow(out, snap.cpuTicks, proc);
+    });
+}
+
+/* Puts a name as a JSON string. */
+static void PutJsonName(ReportBuffer& out, const ProcessName& name) {
+    out.Put('"');
+    for (char c : name.ToString()) {
+        if (c == '"' || c == '\\') {
+            out.Put('\\');
+            out.Put(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+            out.Put(buf);
+        } else {
+            out.Put(c);
+        }
+    }
+    out.Put('"');
+}
+
+static void PutJsonProcess(ReportBuffer& out, const ProcessSummary& proc, bool first) {
+    out.Put(first ? "{\"name\":" : ",{\"name\":");
+    PutJsonName(out, proc.name);
+    out.Put(",\"pid\":"); out.PutInt(proc.pid);
+    out.Put(",\"state\":\""); out.Put(StateName(proc.state));
+    out.Put("\",\"core\":"); out.PutInt(proc.coreAssigned);
+    out.Put(",\"line\":"); out.PutInt(proc.currentLine);
+    out.Put(",\"total\":"); out.PutInt(proc.totalLines);
+    if (proc.finishTime != 0) {
+        out.Put(",\"finish_time\":\""); out.PutTime(proc.finishTime); out.Put('"');
+    }
+    out.Put('}');
+    out.Check();
+}
+
+/* One JSON object per report on a single line, so an incremental file is
+   valid JSON Lines and a regular report is a plain JSON document. */
+static void WriteJson(ReportBuffer& out, const SchedulerSnapshot& snap, time_t now, size_t skip, bool incremental) {
+    out.Put("{\"tick\":"); out.PutInt(snap.cpuTicks);
+    out.Put(",\"time\":\""); out.Put(FormatTimestamp(now));
+    out.Put("\",\"cpu_utilization\":"); out.PutPercent(snap.cpuUtilization);
+    out.Put(",\"cores_used\":"); out.PutInt(snap.coresUsed);
+    out.Put(",\"cores_available\":"); out.PutInt(snap.numCPU - snap.coresUsed);
+    out.Put(",\"incremental\":"); out.Put(incremental ? "true" : "false");
+    out.Put(",\"finished_total\":"); out.PutInt(static_cast<long long>(snap.finishedCount));
+
+    out.Put(",\"unfinished\":[");
+    bool first = true;
+    for (auto proc : snap.Unfinished()) {
+        PutJsonProcess(out, *proc, first);
+        first = false;
+    }
+
+    out.Put("],\"finished\":[");
+    first = true;
+    ForEachFinished(snap, skip, [&](const ProcessSummary& proc) {
+        PutJsonProcess(out, proc, first);
+        first = false;
+    });
+    out.Put("]}");
+    out.EndLine();
+}
+
+/* Constructor starts the writer thread; it sleeps until a report is submitted. */
+ReportWriter::ReportWriter() : busy(false), stopping(false) {
+    worker = thread(&ReportWriter::WorkerLoop, this);
+}
+
+/* Destructor finishes every queued report before the thread exits, so a
+   report requested just before "exit" is still written. */
+ReportWriter::~ReportWriter() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+/* Queues a report of snapshot and returns at once.
+   Called by Console::ReportUtil(). */
+void ReportWriter::Submit(shared_ptr<const SchedulerSnapshot> snapshot, const ReportRequest& request, time_t now) {
+    {
+        lock_guard<mutex> guard(lock);
+        jobs.push_back({ move(snapshot), request, now });
+    }
+    wake.notify_one();
+}
+
+/* Blocks until every queued report has been written. Used by headless runs,
+   which exit right after their final report. */
+void ReportWriter::Wait() {
+    unique_lock<mutex> guard(lock);
+    idle.wait(guard, [this]() { return jobs.empty() && !busy; });
+}
+
+/* Writer thread: takes one job at a time and writes it without holding the lock. */
+void ReportWriter::WorkerLoop() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this]() { return stopping || !jobs.empty(); });
+        if (jobs.empty()) break;
+
+        Job job = move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        guard.unlock();
+
+        string error;
+        if (!Write(job, error)) {
+            cerr << "Error: " << error << endl;
+        }
+
+        guard.lock();
+        busy = false;
+        if (jobs.empty()) {
+            idle.notify_all();
+        }
+    }
+}
+
+/* Writes one report. An incremental report appends to a file this writer
+   already reported into, starting after the last finished process it wrote;
+   anything else (first report, plain report, restored checkpoint with fewer
+   finished processes) rewrites the file from scratch. */
+bool ReportWriter::Write(const Job& job, string& error) {
+    const SchedulerSnapshot& snap = *job.snapshot;
+    const ReportRequest& request = job.request;
+
+    size_t skip = 0;
+    bool appending = false;
+    if (request.incremental) {
+        auto it = reported.find(request.fileName);
+        if (it != reported.end() && it->second <= snap.finishedCount) {
+            skip = it->second;
+            appending = true;
+        }
+    } else {
+        reported.erase(request.fileName);
+    }
+
+    ofstream file(request.fileName, appending ? (ios::out | ios::app) : (ios::out | ios::trunc));
+    if (!file.is_open()) {
+        error = "Could not create log file " + request.fileName + ".";
+        return false;
+    }
+
+    {
+        ReportBuffer out(file);
+        switch (request.format) {
+        case REPORT_CSV:
+            WriteCsv(out, snap, skip, appending);
+            break;
+        case REPORT_JSON:
+            WriteJson(out, snap, job.now, skip, request.incremental);
+            break;
+        default:
+            WriteText(out, snap, job.now, skip, appending);
+            break;
+        }
+    }
+
+    file.close();
+    if (file.fail()) {
+        error = "write to " + request.fileName + " failed.";
+        return false;
+    }
+    if (request.incremental) {
+        reported[request.fileName] = snap.finishedCount;
+    }
+    return true;
+}
+
+/* Maps "text", "csv" or "json" to a ReportFormat. */
+bool ReportWriter::ParseFormat(const string& name, ReportFormat& format) {
+    if (name == "text" || name == "txt") format = REPORT_TEXT;
+    else if (name == "csv") format = REPORT_CSV;
+    else if (name == "json") format = REPORT_JSON;
+    else return false;
+    return true;
+}
+
+/* Report file used when report-util is not given one. */
+string ReportWriter::DefaultFileName(ReportFormat format) {
+    switch (format) {
+    case REPORT_CSV: return "csopesy-log.csv";
+    case REPORT_JSON: return "csopesy-log.json";
+    default: return "csopesy-log.txt";
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <memory>
+#include <ctime>
+#include "snapshot.h"
+
+using namespace std;
+
+enum ReportFormat {
+    REPORT_TEXT,
+    REPORT_CSV,
+    REPORT_JSON
+};
+
+/* What report-util was asked for. Incremental reports append to fileName and
+   only list the processes that finished since the last report to that file. */
+struct ReportRequest {
+    string fileName = "csopesy-log.txt";
+    ReportFormat format = REPORT_TEXT;
+    bool incremental = false;
+};
+
+/* Writes utilization reports on a background thread. Each report is built
+   from one published SchedulerSnapshot, so it is consistent and neither the
+   console nor the tick thread waits for the disk. Output is assembled in a
+   large buffer and written in big blocks instead of flushing per line. */
+class ReportWriter {
+private:
+    struct Job {
+        shared_ptr<const SchedulerSnapshot> snapshot;
+        ReportRequest request;
+        time_t now;
+    };
+
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    condition_variable idle;
+    deque<Job> jobs;
+    bool busy;
+    bool stopping;
+
+    // Finished processes already written to each incremental report file
+    unordered_map<string, size_t> reported;
+
+    void WorkerLoop();
+    bool Write(const Job& job, string& error);
+
+public:
+    ReportWriter();
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    void Submit(shared_ptr<const SchedulerSnapshot> snapshot, const ReportRequest& request, time_t now);
+    void Wait();
+
+    static bool ParseFormat(const string& name, ReportFormat& format);
+    static string DefaultFileName(ReportFormat format);
+};
+
+string FormatTimestamp(time_t t);
+
+#endif
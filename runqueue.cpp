@@ -0,0 +1,205 @@
+/* Ready queues: one global FIFO or one queue per core with work stealing */
+
+#include <algorithm>
+#include "runqueue.h"
+#include "process.h"
+
+using namespace std;
+
+/* Constructor starts with a single global FIFO queue until Configure() is called. */
+RunQueues::RunQueues() : mode(GLOBAL_FIFO), stealOldest(false), total(0), nextCore(0) {
+    queues.emplace_back(new CoreQueue());
+}
+
+/* Sets up the queues for the configured number of cores.
+   GLOBAL_FIFO keeps one shared queue (the old readyQueue order),
+   PER_CORE gives every core its own local queue. stealFromFront makes
+   Steal() take the oldest process instead of the newest (see there). */
+void RunQueues::Configure(int numCores, RunQueueMode queueMode, bool stealFromFront) {
+    mode = queueMode;
+    stealOldest = stealFromFront;
+    nextCore = 0;
+    total = 0;
+
+    int count = (mode == PER_CORE && numCores > 0) ? numCores : 1;
+    queues.clear();
+    for (int i = 0; i < count; i++) {
+        queues.emplace_back(new CoreQueue());
+    }
+}
+
+/* Sets the queue the next process without a preferred core goes to. Used
+   when a checkpoint is restored, so new processes land where they would have. */
+void RunQueues::SetNextCore(int coreId) {
+    nextCore = (coreId >= 0 && coreId < static_cast<int>(queues.size())) ? coreId : 0;
+}
+
+/* Maps a core to the queue it owns. All cores share queue 0 in GLOBAL_FIFO mode. */
+RunQueues::CoreQueue& RunQueues::QueueFor(int coreId) {
+    if (mode == GLOBAL_FIFO || coreId < 0 || coreId >= static_cast<int>(queues.size())) {
+        return *queues[0];
+    }
+    return *queues[coreId];
+}
+
+/* Adds a ready process. Processes that already ran go back to the queue of the
+   core they last used; new ones are spread over the cores round-robin. */
+void RunQueues::Push(Process* proc, int preferredCore) {
+    int target = preferredCore;
+    if (mode == PER_CORE && (target < 0 || target >= static_cast<int>(queues.size()))) {
+        target = nextCore;
+        nextCore = (nextCore + 1) % static_cast<int>(queues.size());
+    }
+
+    CoreQueue& queue = QueueFor(target);
+    lock_guard<mutex> guard(queue.lock);
+    queue.items.push_back(proc);
+    total++;
+    queue.stats.enqueued++;
+    queue.stats.depth = queue.items.size();
+    if (queue.stats.depth > queue.stats.maxDepth) {
+        queue.stats.maxDepth = queue.stats.depth;
+    }
+}
+
+/* Takes the next process for a core: the front of its own queue, or a
+   process stolen from the busiest other queue when its own is empty.
+   Counts a migration whenever the process last ran on a different core. */
+Process* RunQueues::Pop(int coreId) {
+    if (total == 0) return nullptr;
+
+    CoreQueue& own = QueueFor(coreId);
+    Process* proc = nullptr;
+    {
+        lock_guard<mutex> guard(own.lock);
+        if (!own.items.empty()) {
+            proc = own.items.front();
+            own.items.pop_front();
+            total--;
+            own.stats.depth = own.items.size();
+        }
+    }
+
+    if (proc == nullptr && mode == PER_CORE) {
+        proc = Steal(coreId);
+    }
+    if (proc == nullptr) return nullptr;
+
+    lock_guard<mutex> guard(own.lock);
+    own.stats.dispatched++;
+    int lastCore = proc->GetCoreAssigned();
+    if (lastCore != -1 && lastCore != coreId) {
+        own.stats.migrations++;
+    }
+    return proc;
+}
+
+/* Work stealing: an idle core takes a process from the deepest other queue.
+   Each queue is a deque behind its own mutex, locked for the depth scan and
+   again for the take; all dispatch currently runs on the tick thread, so the
+   locks are never contended. Round Robin steals the newest process from the
+   back, leaving the victim's next few in place. FCFS steals the oldest from
+   the front, so stealing never lets a late arrival jump its own queue; each
+   core still runs its own queue first, so per-core FCFS is FIFO per core,
+   not across cores (run-queue global for strict arrival order). */
+Process* RunQueues::Steal(int thiefId) {
+    int victim = -1;
+    size_t deepest = 0;
+    for (int i = 0; i < static_cast<int>(queues.size()); i++) {
+        if (i == thiefId) continue;
+        lock_guard<mutex> guard(queues[i]->lock);
+        if (queues[i]->items.size() > deepest) {
+            deepest = queues[i]->items.size();
+            victim = i;
+        }
+    }
+    if (victim == -1) return nullptr;
+
+    Process* proc = nullptr;
+    {
+        CoreQueue& queue = *queues[victim];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.items.empty()) return nullptr;
+        if (stealOldest) {
+            proc = queue.items.front();
+            queue.items.pop_front();
+        } else {
+            proc = queue.items.back();
+            queue.items.pop_back();
+        }
+        total--;
+        queue.stats.depth = queue.items.size();
+    }
+
+    CoreQueue& thief = QueueFor(thiefId);
+    lock_guard<mutex> guard(thief.lock);
+    thief.stats.steals++;
+    return proc;
+}
+
+/* True when no queue holds a ready process. */
+bool RunQueues::Empty() const {
+    return total == 0;
+}
+
+/* Total number of ready processes over all queues. */
+size_t RunQueues::Size() const {
+    return total;
+}
+
+/* Checks whether a process is already waiting in any queue.
+   Used by Scheduler::TryAssignProcess() to avoid queueing it twice. */
+bool RunQueues::Contains(Process* proc) const {
+    for (const auto& queue : queues) {
+        lock_guard<mutex> guard(queue->lock);
+        for (auto queued : queue->items) {
+            if (queued == proc) return true;
+        }
+    }
+    return false;
+}
+
+/* Takes a process out of whichever queue holds it. Linear, like Contains();
+   used by Scheduler::TryAssignProcess() when process-smi puts a queued
+   process straight on a core. */
+bool RunQueues::Remove(Process* proc) {
+    for (auto& queue : queues) {
+        lock_guard<mutex> guard(queue->lock);
+        auto it = find(queue->items.begin(), queue->items.end(), proc);
+        if (it == queue->items.end()) continue;
+
+        queue->items.erase(it);
+        total--;
+        queue->stats.depth = queue->items.size();
+        return true;
+    }
+    return false;
+}
+
+/* Appends the processes of one queue to out, front first.
+   Used by Scheduler::SaveCheckpoint() to keep the queue order. */
+void RunQueues::Collect(int queueId, vector<Process*>& out) const {
+    if (queueId < 0 || queueId >= static_cast<int>(queues.size())) return;
+    lock_guard<mutex> guard(queues[queueId]->lock);
+    out.insert(out.end(), queues[queueId]->items.begin(), queues[queueId]->items.end());
+}
+
+/* Empties every queue and resets the counters. */
+void RunQueues::Clear() {
+    for (auto& queue : queues) {
+        lock_guard<mutex> guard(queue->lock);
+        queue->items.clear();
+        queue->stats = RunQueueStats();
+    }
+    total = 0;
+    nextCore = 0;
+}
+
+/* Returns a copy of the counters of one queue. */
+RunQueueStats RunQueues::GetStats(int queueId) const {
+    if (queueId < 0 || queueId >= static_cast<int>(queues.size())) {
+        return RunQueueStats();
+    }
+    lock_guard<mutex> guard(queues[queueId]->lock);
+    return queues[queueId]->stats;
+}
@@ -0,0 +1,66 @@
+#ifndef RUNQUEUE_H
+#define RUNQUEUE_H
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <atomic>
+
+using namespace std;
+
+class Process;
+
+enum RunQueueMode {
+    GLOBAL_FIFO,
+    PER_CORE
+};
+
+struct RunQueueStats {
+    unsigned long long enqueued = 0;
+    unsigned long long dispatched = 0;
+    unsigned long long steals = 0;
+    unsigned long long migrations = 0;
+    size_t depth = 0;
+    size_t maxDepth = 0;
+};
+
+class RunQueues {
+private:
+    struct CoreQueue {
+        mutable mutex lock;
+        deque<Process*> items;
+        RunQueueStats stats;
+    };
+
+    RunQueueMode mode;
+    bool stealOldest;   // FCFS: thieves take the front, keeping arrival order across cores
+    vector<unique_ptr<CoreQueue>> queues;
+    atomic<size_t> total;
+    int nextCore;
+
+    CoreQueue& QueueFor(int coreId);
+    Process* Steal(int thiefId);
+
+public:
+    RunQueues();
+
+    void Configure(int numCores, RunQueueMode queueMode, bool stealFromFront = false);
+    RunQueueMode GetMode() const { return mode; }
+    int GetNextCore() const { return nextCore; }
+    void SetNextCore(int coreId);
+    int GetQueueCount() const { return static_cast<int>(queues.size()); }
+
+    void Push(Process* proc, int preferredCore);
+    Process* Pop(int coreId);
+    bool Empty() const;
+    size_t Size() const;
+    bool Contains(Process* proc) const;
+    bool Remove(Process* proc);
+    void Collect(int queueId, vector<Process*>& out) const;
+    void Clear();
+
+    RunQueueStats GetStats(int queueId) const;
+};
+
+#endif
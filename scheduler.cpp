@@ -1,26 +1,49 @@
 /* Process scheduling logic and scheduling algorithm */
 
 #include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <climits>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
 #include "scheduler.h"
+#include "simclock.h"
 
 using namespace std;
 
 /* Constructor initializes the scheduler with default configuration values 
    if config.txt is not found. */
-Scheduler::Scheduler(): currentPID(1), cpuTicks(0), 
+Scheduler::Scheduler(): masterSeed(0), generationDue(0), deferGeneration(false), sliceRetryTick(0), coresUsed(0), hasCommands(false), wakeRequested(false), commandSerial(0),
+                        snapshotVersion(0), snapshotTick(-1), snapshotSerial(0), currentPID(1), cpuTicks(0),
                         processCounter(1), isRunning(false) {
     config.numCPU = 4;
     config.type = ROUND_ROBIN;
     config.quantumCycles = 5;
     config.batchProcessFreq = 1;
+    config.batchSize = 1;
+    config.generatorThreads = 1;
     config.minIns = 1000;
     config.maxIns = 2000;
     config.delaysPerExec = 0;
+    config.workerThreads = 0;
+    config.runQueueMode = PER_CORE;
+    config.execBackend = BACKEND_BYTECODE;
+    config.lazyWindow = 0;
+    config.optimizePrograms = true;
+    config.logRingSize = 64;
+    config.logSpillDir = ".";
+    config.metrics = true;
+    config.tickBudgetMs = 100;
+    config.tickRate = 10;
+    config.slicedExecution = false;
+    config.statsFile = "";
+    config.statsInterval = 600;
+    config.retireAfter = 600;
 
     numCPU = config.numCPU;
     type = config.type;
@@ -29,15 +52,28 @@ Scheduler::Scheduler(): currentPID(1), cpuTicks(0),
     minIns = config.minIns;
     maxIns = config.maxIns;
     delaysPerExec = config.delaysPerExec;
+    workerThreads = config.workerThreads;
+    programOptions.backend = config.execBackend;
+    programOptions.lazyWindow = config.lazyWindow;
+    programOptions.optimize = config.optimizePrograms;
+    programOptions.logCapacity = config.logRingSize;
 
-    //srand(time(NULL));
+    for (int i = READY; i <= FINISHED; i++) {
+        stateLists[i].SetId(i);
+        stateChanges[i] = 0;
+    }
+    for (int i = READY; i < FINISHED; i++) {
+        chunkChanges[i] = 0;
+    }
+    CreatePolicy();
 }
 
 /* Destructor cleans up all dynamically allocated processes.
    Called when the console terminates, ensuring no memory leaks. */
 Scheduler::~Scheduler() {
+    producer.Shutdown();
     for (auto proc : allProcesses) {
-        delete proc;
+        processPool.Destroy(proc);
     }
 }
 
@@ -45,6 +81,13 @@ Scheduler::~Scheduler() {
    This is called by Console::Initialize() to set up the scheduling environment. */
 void Scheduler::Initialize(const string& configFile) {
     LoadConfig(configFile);
+    Initialize(config);
+}
+
+/* Initializes from an already-built Config instead of a file.
+   Used by the benchmark and by Initialize(configFile) above. */
+void Scheduler::Initialize(const Config& settings) {
+    config = settings;
 
     numCPU = config.numCPU;
     type = config.type;
@@ -53,22 +96,81 @@ void Scheduler::Initialize(const string& configFile) {
     minIns = config.minIns;
     maxIns = config.maxIns;
     delaysPerExec = config.delaysPerExec;
+    workerThreads = config.workerThreads;
+    programOptions.backend = config.execBackend;
+    programOptions.lazyWindow = config.lazyWindow;
+    programOptions.optimize = config.optimizePrograms;
+    programOptions.logCapacity = config.logRingSize;
+
+    // Without a seed key every run gets its own workload; the seed is printed so it can be repeated
+    if (config.seed >= 0) {
+        masterSeed = static_cast<uint64_t>(config.seed);
+    } else {
+        masterSeed = static_cast<uint64_t>(time(NULL)) ^
+            static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count());
+        masterSeed &= 0x7fffffffffffffffULL;
+    }
+    programOptions.seed = masterSeed;
 
     for (int i = 0; i < numCPU; i++) {
         coreAssignments[i] = nullptr;
     }
+    coreQuantum.assign(numCPU, 0);
+    coresUsed = 0;
+    CreatePolicy();
+    metrics.Configure(config.metrics, config.tickBudgetMs);
+    if (config.statsInterval <= 0) {
+        config.statsInterval = 600;
+    }
+    if (config.tickRate < 0) {
+        config.tickRate = 0;
+    }
+    if (config.logSpillDir != "none") {
+        logSpill.Open(config.logSpillDir);
+        programOptions.logSpill = &logSpill;
+    }
+
+    // 0 = execute inline on the tick thread; the pool only starts when a
+    // count is given, and never has more slots than simulated cores
+    int slots = max(1, min(workerThreads, numCPU));
+    workers.Start(slots);
+    slotCores.assign(slots, vector<pair<int, Process*>>());
+    if (config.batchSize < 1) {
+        config.batchSize = 1;
+    }
+    StartProducer();
 
     /* To comment out, hindi yata kasama sa specs na dapat ipakita, for checking lang */
     cout << "System initialized with:" << endl;
     cout << "CPUs: " << numCPU << endl;
-    cout << "Scheduler: " << (type == FCFS ? "FCFS" : "Round Robin") << endl;
-    if (type == ROUND_ROBIN) {
+    cout << "Scheduler: " << SchedulingPolicy::GetName(type) << endl;
+    if (policy->UsesQuantum()) {
         cout << "Quantum cycles: " << quantumCycles << endl;
     }
+    cout << "Seed: " << masterSeed << endl;
+    if (config.tickRate > 0) {
+        cout << "Tick rate: " << config.tickRate << " ticks/s" << endl;
+    } else {
+        cout << "Tick rate: unpaced" << endl;
+    }
     cout << "Batch process frequency: " << batchProcessFreq << endl;
+    if (config.batchSize > 1) {
+        cout << "Batch size: " << config.batchSize << endl;
+    }
     cout << "Min instructions: " << minIns << endl;
     cout << "Max instructions: " << maxIns << endl;
     cout << "Delays per exec: " << delaysPerExec << endl;
+    cout << "Worker threads: " << workers.GetSlotCount() << endl;
+    cout << "Generator threads: " << producer.GetThreadCount() << endl;
+    cout << "Exec backend: " << (programOptions.backend == BACKEND_BYTECODE ? "bytecode" : "objects") << endl;
+    if (programOptions.backend == BACKEND_BYTECODE && programOptions.lazyWindow > 0) {
+        cout << "Generation: lazy, " << programOptions.lazyWindow << " lines per window" << endl;
+    }
+    cout << "Program optimizer: " << (programOptions.optimize ? "on" : "off") << endl;
+    cout << "Sliced execution: " << (config.slicedExecution ? "on" : "off") << endl;
+    cout << "Ready queue: " << policy->GetDescription() << endl;
+    cout << "Log ring: " << programOptions.logCapacity << " entries per process, spill "
+        << (logSpill.IsOpen() ? "to " + config.logSpillDir : string("off")) << endl;
 }
 
 /* Reads scheduler configuration from config.txt, setting algorithm type and process parameters.
@@ -95,8 +197,7 @@ void Scheduler::LoadConfig(const string& filename) {
                 config.numCPU = stoi(value);
             }
             else if (key == "scheduler") {
-                if (value == "fcfs") config.type = FCFS;
-                else if (value == "rr") config.type = ROUND_ROBIN;
+                SchedulingPolicy::ParseKey(value, config.type);
             }
             else if (key == "quantum-cycles") {
                 config.quantumCycles = stoi(value);
@@ -104,154 +205,549 @@ void Scheduler::LoadConfig(const string& filename) {
             else if (key == "batch-process-freq") {
                 config.batchProcessFreq = stoi(value);
             }
+            else if (key == "batch-size") {
+                config.batchSize = stoi(value);
+            }
+            else if (key == "generator-threads") {
+                config.generatorThreads = stoi(value);
+            }
+            else if (key == "seed") {
+                config.seed = (value == "random") ? -1 : stoll(value);
+            }
             else if (key == "min-ins") {
                 config.minIns = stoi(value);
             }
             else if (key == "max-ins") {
                 config.maxIns = stoi(value);
             }
-            else if (key == "delays-per-exec") {
+            else if (key == "delay-per-exec" || key == "delays-per-exec") {
                 config.delaysPerExec = stoi(value);
             }
+            else if (key == "worker-threads") {
+                config.workerThreads = stoi(value);
+            }
+            else if (key == "exec-backend") {
+                if (value == "bytecode") config.execBackend = BACKEND_BYTECODE;
+                else if (value == "objects") config.execBackend = BACKEND_OBJECTS;
+            }
+            else if (key == "lazy-window") {
+                config.lazyWindow = stoi(value);
+            }
+            else if (key == "optimize-programs") {
+                config.optimizePrograms = (value == "on" || value == "true" || value == "1");
+            }
+            else if (key == "sliced-execution") {
+                config.slicedExecution = (value == "on" || value == "true" || value == "1");
+            }
+            else if (key == "log-ring-size") {
+                config.logRingSize = stoi(value);
+            }
+            else if (key == "log-spill-dir") {
+                config.logSpillDir = value;
+            }
+            else if (key == "metrics") {
+                config.metrics = (value == "on" || value == "true" || value == "1");
+            }
+            else if (key == "tick-budget-ms") {
+                config.tickBudgetMs = stoi(value);
+            }
+            else if (key == "tick-rate") {
+                config.tickRate = (value == "max") ? 0 : stod(value);
+            }
+            else if (key == "stats-file") {
+                config.statsFile = value;
+            }
+            else if (key == "stats-interval") {
+                config.statsInterval = stoi(value);
+            }
+            else if (key == "priority-levels") {
+                config.priorityLevels = stoi(value);
+            }
+            else if (key == "mlfq-levels") {
+                config.mlfqLevels = stoi(value);
+            }
+            else if (key == "mlfq-boost-interval") {
+                config.mlfqBoostInterval = stoi(value);
+            }
+            else if (key == "retire-after") {
+                config.retireAfter = (value == "never") ? -1 : stoi(value);
+            }
+            else if (key == "run-queue") {
+                if (value == "global") config.runQueueMode = GLOBAL_FIFO;
+                else if (value == "per-core") config.runQueueMode = PER_CORE;
+            }
         }
     }
 
     file.close();
 }
 
+// Ticks between retirement passes (see RetireFinished)
+static const int RETIRE_INTERVAL = 64;
+
 /* Executes one CPU cycle across all cores.
    Generates new processes based on frequency, executes running processes,
-   handles preemption for Round Robin, and manages process state transitions. */
+   handles preemption, and manages process state transitions.
+   FCFS fills idle cores before executing; the other policies execute first,
+   let better ready processes preempt (SRTF, priority, MLFQ) and refill the
+   freed cores afterwards. Each phase is timed by TickMetrics. */
 void Scheduler::Tick() {
+    // Apply console requests between ticks, never in the middle of one
+    if (hasCommands.load(memory_order_acquire)) {
+        RunCommands();
+    }
+
     cpuTicks++;
+    SimClock::SetTick(cpuTicks);
+
+    uint64_t tickStart = metrics.BeginTick();
+    uint64_t mark = tickStart;
+
+    // Generate new processes periodically if running; the producers built them
+    // already, and any they have not finished are linked in on a later tick
+    if (isRunning && cpuTicks % batchProcessFreq == 0) {
+        GenerateBatch();
+    } else if (generationDue > 0) {
+        AdmitGenerated();
+    }
+    mark = metrics.EndPhase(PHASE_GENERATE, mark);
+
+    // FCFS assigns ready processes to idle cores before executing
+    if (policy->DispatchesBeforeExecute()) {
+        DispatchIdleCores();
+        mark = metrics.EndPhase(PHASE_DISPATCH, mark);
+    }
+
+    // Execute one instruction for each running process; quantum policies also handle expiration
+    RunCores();
+    mark = metrics.EndPhase(PHASE_EXECUTE, mark);
+
+    // Handle waiting processes (sleep)
+    WakeSleepers();
+    mark = metrics.EndPhase(PHASE_WAKE, mark);
 
-    /* For FCFS logic */
-    if (type == FCFS) {
-        // Generate new processes periodically if running
-        if (isRunning && cpuTicks % batchProcessFreq == 0) {
-            string processName = "process" + to_string(processCounter++);
-            CreateNewProcess(processName);
+    // The other policies refill the cores that were freed this tick; idle
+    // cores are filled first so preemption only displaces a process when
+    // no core is free for the better one
+    if (!policy->DispatchesBeforeExecute()) {
+        policy->OnTick(cpuTicks);
+        // Prevent lingering -1 assignments
+        DispatchIdleCores();
+        if (policy->IsPreemptive()) {
+            PreemptForBetter();
         }
+        mark = metrics.EndPhase(PHASE_DISPATCH, mark);
+    }
 
-        // Assign ready processes to any idle cores
-        for (int i = 0; i < numCPU; ++i) {
-            if (coreAssignments[i] == nullptr && !readyQueue.empty()) {
-                Process* nextProc = readyQueue.front();
-                readyQueue.pop();
+    metrics.EndTick(tickStart, policy->Size(), sleepQueue.Size());
 
-                nextProc->SetState(RUNNING);
-                nextProc->SetCoreAssigned(i);
-                coreAssignments[i] = nextProc;
-            }
+    // Retirement is batched: a pass compacts allProcesses once for everyone due
+    if (config.retireAfter >= 0 && cpuTicks % RETIRE_INTERVAL == 0) {
+        RetireFinished();
+    }
+
+    if (metrics.IsEnabled() && !config.statsFile.empty() && cpuTicks % config.statsInterval == 0) {
+        WriteStatsFile();
+    }
+}
+
+/* Counts the ticks, starting with the next one, in which nothing can happen:
+   every occupied core is busy-waiting on delay-per-exec and no wakeup, delay
+   or quantum expiry, generation, MLFQ boost, retirement pass or stats write
+   is due. Each source knows its next tick (the timing wheel for sleepers,
+   the delay and quantum counters for cores, the batch frequency for
+   generation), so this is O(cores) rather than a scan of the processes.
+   Returns 0 when the next tick has work and -1 when nothing is pending until
+   a command arrives. */
+long long Scheduler::CountIdleTicks() const {
+    if (hasCommands.load(memory_order_acquire)) return 0;
+
+    long long now = cpuTicks;
+    long long next = LLONG_MAX;
+    bool idleCore = false;
+    for (int i = 0; i < numCPU; ++i) {
+        Process* proc = coreAssignments.at(i);
+        if (proc == nullptr) {
+            idleCore = true;
+            continue;
+        }
+        // A process placed on a second core by process-smi runs twice per tick; just tick it
+        if (proc->GetDelayCounter() <= 0 || proc->GetState() != RUNNING || proc->GetCoreAssigned() != i) {
+            return 0;
+        }
+
+        next = min(next, now + proc->GetDelayCounter() + 1);
+        if (policy->UsesQuantum()) {
+            int left = policy->GetQuantum(proc) - coreQuantum[i];
+            next = min(next, now + max(1, left));
+        }
+        if (policy->IsPreemptive() && !policy->Empty() && policy->ShouldPreempt(proc)) {
+            return 0;
+        }
+    }
+    if (idleCore && !policy->Empty()) return 0;
+
+    next = min(next, NextEventTick());
+    if (next == LLONG_MAX) return -1;
+    return max(0LL, next - now - 1);
+}
+
+/* First tick after the current one at which something other than the
+   running processes is due: generation, a wakeup, an MLFQ boost, a
+   retirement pass or a stats write. LLONG_MAX when none is. A generated
+   process still waiting on its producer makes every tick an event. */
+long long Scheduler::NextEventTick() const {
+    long long now = cpuTicks;
+    long long next = LLONG_MAX;
+
+    if (isRunning) {
+        long long freq = max(1, batchProcessFreq);
+        next = min(next, (now / freq + 1) * freq);
+    }
+    if (generationDue > 0) {
+        next = now + 1;
+    }
+    if (sleepQueue.Size() > 0) {
+        next = min(next, static_cast<long long>(sleepQueue.NextExpiry()));
+    }
+    int boost = policy->NextTickEvent(cpuTicks);
+    if (boost >= 0) {
+        next = min(next, static_cast<long long>(boost));
+    }
+    if (config.retireAfter >= 0 && !stateLists[FINISHED].Empty()) {
+        long long due = max(now + 1, static_cast<long long>(stateLists[FINISHED].Front()->GetFinishTick()) + config.retireAfter);
+        next = min(next, (due + RETIRE_INTERVAL - 1) / RETIRE_INTERVAL * RETIRE_INTERVAL);
+    }
+    if (metrics.IsEnabled() && !config.statsFile.empty()) {
+        next = min(next, (now / config.statsInterval + 1) * config.statsInterval);
+    }
+    return next;
+}
+
+/* Jumps the clock over ticks that CountIdleTicks() found empty, with the
+   same effect as ticking through them: busy-waiting cores use up their delay
+   and quantum and the timing wheel moves on. Nothing else changes. Returns
+   the ticks skipped, fewer than count only where the int tick counter runs
+   out. */
+long long Scheduler::SkipTicks(long long count) {
+    count = min(count, static_cast<long long>(INT_MAX - cpuTicks));
+    if (count <= 0) return 0;
+
+    int ticks = static_cast<int>(count);
+    cpuTicks += ticks;
+    SimClock::SetTick(cpuTicks);
+
+    for (int i = 0; i < numCPU; ++i) {
+        Process* proc = coreAssignments[i];
+        if (proc == nullptr) continue;
+        proc->SkipDelay(ticks);
+        if (policy->UsesQuantum()) {
+            coreQuantum[i] += ticks;
+        }
+    }
+    WakeSleepers();
+    metrics.CountSkipped(static_cast<uint64_t>(count));
+    return count;
+}
+
+// Shorter stretches cost more to set up as a slice than to tick through
+static const int MIN_SLICE_TICKS = 2;
+
+/* Number of ticks, up to maxTicks, that can run as one slice: no core is
+   free while processes are ready, and before the next event (generation,
+   wakeup, boost, retirement, stats) no core sleeps, finishes, reaches the
+   end of its quantum or would be preempted. Below MIN_SLICE_TICKS means
+   no slice. */
+int Scheduler::SliceLength(int maxTicks) const {
+    // Cores first: they usually rule a slice out before the event horizon is worth computing
+    long long limit = maxTicks;
+    bool idleCore = false;
+    bool busyCore = false;
+    for (int i = 0; i < numCPU && limit >= MIN_SLICE_TICKS; ++i) {
+        Process* proc = coreAssignments.at(i);
+        if (proc == nullptr) {
+            idleCore = true;
+            continue;
         }
+        if (proc->GetState() != RUNNING || proc->GetCoreAssigned() != i) return 0;
+        if (policy->IsPreemptive() && !policy->Empty() && policy->ShouldPreempt(proc)) return 0;
+
+        busyCore = true;
+        if (policy->UsesQuantum()) {
+            limit = min(limit, static_cast<long long>(policy->GetQuantum(proc) - coreQuantum[i] - 1));
+        }
+        limit = proc->CountQuietSteps(static_cast<int>(max(0LL, limit)));
+    }
+    if (!busyCore || (idleCore && !policy->Empty()) || limit < MIN_SLICE_TICKS) return 0;
+
+    limit = min(limit, NextEventTick() - cpuTicks - 1);
+    return static_cast<int>(max(0LL, limit));
+}
+
+/* Runs up to maxTicks ticks as one slice when nothing in them needs the
+   per-tick interleaving of Tick() (see SliceLength()) and no command is
+   waiting. Each core then runs its stretch with Process::ExecuteSlice() on
+   its own, in parallel when workers are configured, and the bookkeeping is
+   done once. The slice stops the tick before the first event, which then
+   runs as a normal Tick(). A refusal knows the event that is too close, and
+   no slice can start before it has run, so the calls in between return at
+   once instead of recounting cores and events. Returns the number of ticks
+   run; 0 means the caller should Tick(). */
+int Scheduler::RunSlice(int maxTicks) {
+    if (maxTicks < MIN_SLICE_TICKS || hasCommands.load(memory_order_acquire)) return 0;
+    if (cpuTicks < sliceRetryTick) return 0;
 
-        // Execute one instruction for each running process
+    int ticks = SliceLength(maxTicks);
+    if (ticks < MIN_SLICE_TICKS) {
+        // The event after the quiet ticks found; a command can only bring one closer
+        sliceRetryTick = static_cast<long long>(cpuTicks) + ticks + 1;
+        return 0;
+    }
+
+    SimClock::SetTick(cpuTicks + 1);
+    if (!ExecuteCoresParallel(ticks)) {
         for (int i = 0; i < numCPU; ++i) {
             Process* proc = coreAssignments[i];
             if (proc != nullptr) {
-                proc->Execute(i);
-                proc->IncrementExecutionTime();
-
-                if (proc->IsFinished()) {
-                    if (proc->GetFinishTime() == 0)
-                        proc->SetFinishTime(time(nullptr));
+                proc->ExecuteSlice(i, ticks);
+            }
+        }
+    }
 
-                    proc->SetCoreAssigned(-1);
-                    coreAssignments[i] = nullptr;
-                }
+    cpuTicks += ticks;
+    SimClock::SetTick(cpuTicks);
+    if (policy->UsesQuantum()) {
+        for (int i = 0; i < numCPU; ++i) {
+            if (coreAssignments[i] != nullptr) {
+                coreQuantum[i] += ticks;
             }
         }
+    }
+    WakeSleepers();
+    metrics.CountSliced(static_cast<uint64_t>(ticks));
+    return ticks;
+}
+
+/* Gives every idle core the next process chosen by the policy.
+   Quantum policies start a fresh quantum for each dispatched process. */
+void Scheduler::DispatchIdleCores() {
+    for (int i = 0; i < numCPU; ++i) {
+        if (coreAssignments[i] != nullptr) continue;
 
-        // Handle waiting processes (sleep)
-        for (auto proc : allProcesses) {
-            if (proc->GetState() == WAITING) {
-                proc->DecrementWait();
-                if (proc->GetWaitCycles() == 0) {
-                    proc->SetState(READY);
-                    readyQueue.push(proc);
-                }
+        Process* nextProc = policy->Pop(i);
+        if (nextProc != nullptr) {
+            nextProc->SetState(RUNNING);
+            nextProc->SetCoreAssigned(i);
+            SetCore(i, nextProc);
+            TrackState(nextProc);
+            if (policy->UsesQuantum()) {
+                coreQuantum[i] = 0;
             }
+            metrics.CountDispatch();
         }
+    }
+}
 
-        return;
+/* Preemption on arrival (SRTF, priority, MLFQ): a core whose process is
+   worse than the best ready one hands it over. The swap happens core by
+   core, so each core is compared against what is still waiting. */
+void Scheduler::PreemptForBetter() {
+    if (policy->Empty()) return;
+
+    for (int i = 0; i < numCPU; ++i) {
+        Process* proc = coreAssignments[i];
+        if (proc == nullptr || !policy->ShouldPreempt(proc)) continue;
+
+        Process* nextProc = policy->Pop(i);
+        if (nextProc == nullptr) break;
+
+        proc->SetState(READY);
+        policy->Push(proc, i);
+        TrackState(proc);
+        metrics.CountPreemption();
+
+        nextProc->SetState(RUNNING);
+        nextProc->SetCoreAssigned(i);
+        SetCore(i, nextProc);
+        TrackState(nextProc);
+        coreQuantum[i] = 0;
+        metrics.CountDispatch();
+
+        if (policy->Empty()) break;
     }
-    /* For RR logic */
-    if (isRunning && cpuTicks % batchProcessFreq == 0) {
-        string processName = "process" + to_string(processCounter++);
-        CreateNewProcess(processName);
+}
+
+/* Builds the policy for the configured scheduler type. Any queued processes
+   are dropped, so this only runs before processes exist. */
+void Scheduler::CreatePolicy() {
+    PolicySettings settings;
+    settings.type = type;
+    settings.numCores = numCPU;
+    settings.runQueueMode = config.runQueueMode;
+    settings.quantumCycles = quantumCycles;
+    settings.mlfqLevels = config.mlfqLevels;
+    settings.mlfqBoostInterval = config.mlfqBoostInterval;
+    policy = SchedulingPolicy::Create(settings);
+}
+
+/* Rewrites the stats file with the current metrics report. Writes a temporary
+   file first and renames it, so readers never see a half-written report. */
+void Scheduler::WriteStatsFile() {
+    string tempFile = config.statsFile + ".tmp";
+    ofstream file(tempFile);
+    if (!file.is_open()) return;
+
+    file << "CPU ticks: " << cpuTicks << endl;
+    file << "CPU Utilization: " << fixed << setprecision(2) << GetCPUUtilization() << "%" << endl;
+    file << "-----------------------------------------------" << endl;
+    metrics.Report(file);
+    file.close();
+
+    remove(config.statsFile.c_str());
+    rename(tempFile.c_str(), config.statsFile.c_str());
+}
+
+/* Executes one instruction on every occupied core.
+   Uses the worker pool when it can, otherwise falls back to the serial loop
+   where each core's bookkeeping runs right after its own instruction. */
+void Scheduler::RunCores() {
+    if (ExecuteCoresParallel(0)) {
+        for (int i = 0; i < numCPU; ++i) {
+            if (coreAssignments[i] != nullptr) {
+                CompleteStep(i);
+            }
+        }
+        return;
     }
 
     for (int i = 0; i < numCPU; ++i) {
         Process* proc = coreAssignments[i];
-
         if (proc != nullptr) {
-            // Execute process
             proc->Execute(i);
             proc->IncrementExecutionTime();
+            CompleteStep(i);
+        }
+    }
+}
 
-            // Handle quantum expiration
-            processQuantumCounters[proc]++;
+/* Parallel execute phase: cores are split into contiguous groups, one group per
+   worker slot, and each slot calls Process::Execute() for its cores, or
+   Process::ExecuteSlice() for sliceTicks ticks when that is non-zero.
+   A process only touches its own state while executing, so the order between
+   groups does not matter. A process holds at most one core (TryAssignProcess()
+   takes it out of the ready queue), which the check on its assigned core
+   confirms without a per-tick set; should that ever fail, the tick takes the
+   serial path instead. Returns false without executing anything then, or
+   when there are no worker threads. */
+bool Scheduler::ExecuteCoresParallel(int sliceTicks) {
+    int slots = workers.GetSlotCount();
+    if (slots <= 1) return false;
 
-            if (processQuantumCounters[proc] >= quantumCycles && !proc->IsFinished()) {
-                // Preempt process
-                proc->SetState(READY);
-                //proc->SetCoreAssigned(-1); // temporarily unassigned
-                readyQueue.push(proc);
-                coreAssignments[i] = nullptr;
-                processQuantumCounters[proc] = 0;
-            }
+    for (auto& cores : slotCores) {
+        cores.clear();
+    }
 
-            // Handle process completion
-            if (proc->IsFinished()) {
-                if (proc->GetFinishTime() == 0)
-                    proc->SetFinishTime(time(nullptr));
-                proc->SetCoreAssigned(-1);
-                coreAssignments[i] = nullptr;
-            }
-        }
+    for (int i = 0; i < numCPU; ++i) {
+        Process* proc = coreAssignments[i];
+        if (proc == nullptr) continue;
+        if (proc->GetCoreAssigned() != i) return false;
+
+        slotCores[static_cast<long long>(i) * slots / numCPU].push_back(make_pair(i, proc));
     }
 
-    // Handle waiting processes
-    for (auto proc : allProcesses) {
-        if (proc->GetState() == WAITING) {
-            proc->DecrementWait();
-            if (proc->GetWaitCycles() == 0) {
-                proc->SetState(READY);
-                readyQueue.push(proc);
+    workers.RunPhase([this, sliceTicks](int slot) {
+        for (auto& entry : slotCores[slot]) {
+            if (sliceTicks > 0) {
+                entry.second->ExecuteSlice(entry.first, sliceTicks);
+                continue;
             }
+            entry.second->Execute(entry.first);
+            entry.second->IncrementExecutionTime();
         }
+    });
+    return true;
+}
+
+/* Serial bookkeeping after a core executed one instruction.
+   A process that just ran SLEEP gives up its core and is parked in the
+   timing wheel. Quantum policies (RR, MLFQ) count the quantum and preempt;
+   every policy releases the core when the process finishes. Called in core order so the
+   ready queue sees the same push order as before. */
+void Scheduler::CompleteStep(int coreId) {
+    Process* proc = coreAssignments[coreId];
+
+    // Park sleeping processes off-core until their wake-up tick
+    if (proc->GetState() == WAITING) {
+        sleepQueue.Schedule(proc, static_cast<unsigned long long>(cpuTicks) + proc->GetWaitCycles());
+        SetCore(coreId, nullptr);
+        TrackState(proc);
+        metrics.CountSleep();
+        return;
     }
 
-    // Prevent lingering -1 assignments
-    for (int i = 0; i < numCPU; ++i) {
-        if (coreAssignments[i] == nullptr && !readyQueue.empty()) {
-            Process* nextProc = readyQueue.front();
-            readyQueue.pop();
+    if (policy->UsesQuantum()) {
+        // Handle quantum expiration
+        int& used = coreQuantum[coreId];
+        used++;
 
-            nextProc->SetState(RUNNING);
-            nextProc->SetCoreAssigned(i);
-            coreAssignments[i] = nextProc;
-            processQuantumCounters[nextProc] = 0;
+        if (used >= policy->GetQuantum(proc) && !proc->IsFinished()) {
+            // Preempt process
+            policy->OnQuantumExpired(proc);
+            proc->SetState(READY);
+            //proc->SetCoreAssigned(-1); // temporarily unassigned
+            policy->Push(proc, coreId);
+            SetCore(coreId, nullptr);
+            TrackState(proc);
+            used = 0;
+            metrics.CountPreemption();
         }
     }
+
+    // Handle process completion
+    if (proc->IsFinished()) {
+        if (proc->GetFinishTime() == 0)
+            proc->SetFinishTime(SimClock::Now());
+        proc->SetFinishTick(cpuTicks);
+
+        proc->SetCoreAssigned(-1);
+        SetCore(coreId, nullptr);
+        TrackState(proc);
+        pendingFinished.push_back(proc->GetSummary());
+        metrics.CountCompletion();
+    }
+}
+
+/* Moves every process whose sleep ends on this tick back to the ready queue,
+   preferring the queue of the core it slept on. Only the expiring wheel
+   bucket is touched, not the full process list. */
+void Scheduler::WakeSleepers() {
+    wokenProcesses.clear();
+    sleepQueue.Advance(static_cast<unsigned long long>(cpuTicks), wokenProcesses);
+
+    for (auto proc : wokenProcesses) {
+        proc->SetWaitCycles(0);
+        proc->SetState(READY);
+        TrackState(proc);
+        policy->Push(proc, proc->GetCoreAssigned());
+    }
 }
 
 /* Assigns the next process from ready queue to an available CPU core.
-   For both FCFS and Round Robin, processes are taken from the front of the queue (FIFO).
-   The difference is FCFS never preempts, while RR preempts after quantum expires. */
+   The policy decides which process comes next; FCFS dispatches in Tick() instead. */
 void Scheduler::ScheduleNext(int coreId) {
-    if (type == FCFS) return;
+    if (policy->DispatchesBeforeExecute()) return;
 
-    if (coreAssignments[coreId] == nullptr && !readyQueue.empty()) {
-        Process* nextProc = readyQueue.front();
-        readyQueue.pop();
+    if (coreAssignments[coreId] != nullptr) return;
 
+    Process* nextProc = policy->Pop(coreId);
+    if (nextProc != nullptr) {
         nextProc->SetState(RUNNING);
         nextProc->SetCoreAssigned(coreId);
-        coreAssignments[coreId] = nextProc;
+        SetCore(coreId, nextProc);
+        TrackState(nextProc);
 
-        if (type == ROUND_ROBIN) {
-            processQuantumCounters[nextProc] = 0;
+        if (policy->UsesQuantum()) {
+            coreQuantum[coreId] = 0;
         }
     }
 }
@@ -260,6 +756,7 @@ void Scheduler::ScheduleNext(int coreId) {
    Called by Console::SchedulerStart() command. */
 void Scheduler::Start() {
     isRunning = true;
+    OrderProcesses();
     cout << "Scheduler started generating processes." << endl;
 }
 
@@ -270,49 +767,206 @@ void Scheduler::Stop() {
     cout << "Scheduler stopped generating processes." << endl;
 }
 
-/* Creates a new process with random instruction count and adds it to the ready queue.
-   Used both for manual process creation (screen -s) and automatic generation (scheduler-start). */
+/* Creates a new process from a typed name (screen -s). */
 void Scheduler::CreateNewProcess(const string& name) {
+    CreateNewProcess(ProcessName(name));
+}
+
+/* Creates a new process with random instruction count and adds it to the ready queue.
+   Used for manual process creation (screen -s), and for automatic generation
+   (scheduler-start) when there are no generator threads.
+   The duplicate check and both indexes are hash/array lookups, so creation stays O(1). */
+void Scheduler::CreateNewProcess(const ProcessName& name) {
     // Check for existing process with the same name
-    for (auto existing : allProcesses) {
-        if (existing->GetName() == name) {
-            // Already exists, skip creation
-            //cout << "Skipping duplicate process: " << name << endl;
-            return;
-        }
+    if (nameIndex.find(name) != nameIndex.end()) {
+        // Already exists, skip creation
+        //cout << "Skipping duplicate process: " << name.ToString() << endl;
+        return;
     }
     
-    int numInstructions = minIns + (rand() % (maxIns - minIns + 1));
-    Process* proc = new Process(name, currentPID++, numInstructions, delaysPerExec);
-
-    allProcesses.push_back(proc);
-    readyQueue.push(proc);
+    int pid = currentPID++;
+    int numInstructions, priority;
+    DrawWorkload(pid, numInstructions, priority);
+    Process* proc = processPool.Create(name, pid, numInstructions, delaysPerExec, programOptions);
+    proc->SetPriority(priority);
+    AdmitProcess(proc);
 
     // cout << "Process " << name << " created with " << numInstructions << " instructions." << endl;
     //processLogs.push_back("Process " + name + " created with " + to_string(numInstructions) + " instructions."); // to avoid console flooding of threads
 }
 
-/* Searches for a process by name in the list of all processes.
-   Used by Console for screen commands (screen -r <name>). Returns nullptr if not found. */
-Process* Scheduler::GetProcess(const string& name) {
-    for (auto proc : allProcesses) {
-        if (proc->GetName() == name) {
-            return proc;
+/* Registers a newly built process and queues it. */
+void Scheduler::AdmitProcess(Process* proc) {
+    int pid = proc->GetPID();
+    allProcesses.push_back(proc);
+    nameIndex.emplace(proc->GetProcessName(), pid);
+    if (static_cast<int>(pidIndex.size()) <= pid) {
+        pidIndex.resize(pid + 1);
+    }
+    pidIndex[pid].live = proc;
+    TrackState(proc);
+    policy->Push(proc, -1);
+    metrics.CountCreated();
+}
+
+// Batches the producers may build ahead of the tick that takes them
+static const int GENERATION_LOOKAHEAD = 2;
+
+/* (Re)starts the producer threads with the current options. Orders that were
+   outstanding are submitted again, so nothing is lost across a restart. */
+void Scheduler::StartProducer() {
+    size_t capacity = static_cast<size_t>(max(GENERATION_LOOKAHEAD * config.batchSize, 8));
+    producer.Start(config.generatorThreads, capacity, &processPool, delaysPerExec, programOptions);
+    if (producer.GetThreadCount() == 0) return;
+
+    for (const auto& order : generationOrders) {
+        producer.Submit(order);
+    }
+}
+
+/* Length and (PRIORITY only) static priority of a new process, drawn from
+   its own stream of the master seed, so they depend only on the seed and
+   the PID and not on what was created before. */
+void Scheduler::DrawWorkload(int pid, int& numInstructions, int& priority) const {
+    Random draws(DeriveSeed(masterSeed, static_cast<uint64_t>(pid), STREAM_WORKLOAD));
+    numInstructions = minIns + draws.NextInt(maxIns - minIns + 1);
+    priority = (type == PRIORITY && config.priorityLevels > 0) ? draws.NextInt(config.priorityLevels) : 0;
+}
+
+/* Decides the next generated process: its number, PID and random draws. */
+ProcessOrder Scheduler::MakeOrder() {
+    ProcessOrder order;
+    order.sequence = processCounter++;
+    order.pid = currentPID++;
+    DrawWorkload(order.pid, order.numInstructions, order.priority);
+    return order;
+}
+
+/* Keeps the producers GENERATION_LOOKAHEAD batches ahead of the processes
+   already due. PIDs are handed out here, so a process typed with screen -s
+   meanwhile gets a PID after the ones already ordered. */
+void Scheduler::OrderProcesses() {
+    if (producer.GetThreadCount() == 0) return;
+
+    size_t target = static_cast<size_t>(generationDue + max(GENERATION_LOOKAHEAD * config.batchSize, 8));
+    while (generationOrders.size() < target) {
+        generationOrders.push_back(MakeOrder());
+        producer.Submit(generationOrders.back());
+    }
+}
+
+/* Adds batch-size generated processes. With producer threads they were
+   built off the tick thread and only have to be linked in (see
+   AdmitGenerated()). Without them each is built right here, exactly as
+   CreateNewProcess() always did. */
+void Scheduler::GenerateBatch() {
+    if (producer.GetThreadCount() == 0 && generationOrders.empty()) {
+        for (int i = 0; i < config.batchSize; i++) {
+            CreateNewProcess(ProcessName::Numbered("process", processCounter++));
         }
+        return;
     }
-    return nullptr;
+
+    generationDue += config.batchSize;
+    AdmitGenerated();
 }
 
-/* Counts how many CPU cores currently have processes assigned.
-   Used for calculating CPU utilization and displaying in screen-ls/report-util. */
-int Scheduler::GetCoresUsed() const {
-    int count = 0;
-    for (const auto& pair : coreAssignments) {
-        if (pair.second != nullptr) {
-            count++;
+/* Links in the due processes in order. By default it waits for a producer
+   that is behind, so arrival ticks depend only on the seed and headless and
+   benchmark runs see the same workload on any number of threads. The
+   interactive tick loop sets deferGeneration instead: it stops at the first
+   process that is not built yet, and the rest stay due and are taken on the
+   next ticks. A name taken by screen -s in the meantime is skipped as
+   before. Orders left over from a checkpoint without producer threads are
+   built here. */
+void Scheduler::AdmitGenerated() {
+    while (generationDue > 0 && !generationOrders.empty()) {
+        Process* proc = nullptr;
+        if (producer.GetThreadCount() == 0) {
+            proc = producer.Build(generationOrders.front());
+        } else {
+            proc = producer.TryTake();
+            if (proc == nullptr) {
+                metrics.CountGeneratorWait();
+                if (deferGeneration) break;
+                proc = producer.Take();
+            }
+        }
+        generationOrders.pop_front();
+        generationDue--;
+
+        if (nameIndex.find(proc->GetProcessName()) != nameIndex.end()) {
+            processPool.Destroy(proc);
+            continue;
         }
+        AdmitProcess(proc);
     }
-    return count;
+    // Only without producer threads can orders run out before the due ones
+    for (; generationDue > 0 && generationOrders.empty(); generationDue--) {
+        CreateNewProcess(ProcessName::Numbered("process", processCounter++));
+    }
+    OrderProcesses();
+}
+
+/* Searches for a process by name through the name index.
+   Used by Console for screen commands (screen -r <name>). Returns nullptr if not found. */
+Process* Scheduler::GetProcess(const string& name) {
+    ProcessName key;
+    if (!ProcessName::Find(name, key)) return nullptr;
+
+    auto it = nameIndex.find(key);
+    if (it == nameIndex.end()) return nullptr;
+    return GetProcessByPID(it->second);
+}
+
+/* Returns the process with the given PID, or nullptr (also for retired ones). */
+Process* Scheduler::GetProcessByPID(int pid) const {
+    if (pid < 0 || pid >= static_cast<int>(pidIndex.size())) return nullptr;
+    return pidIndex[pid].live;
+}
+
+/* Returns the PID of a live or retired process by name, or -1.
+   Used by Console for screen -s and screen -r. */
+int Scheduler::FindPID(const string& name) const {
+    ProcessName key;
+    if (!ProcessName::Find(name, key)) return -1;
+
+    auto it = nameIndex.find(key);
+    return (it == nameIndex.end()) ? -1 : it->second;
+}
+
+/* The summary a retired process had when it finished. */
+static ProcessSummary SummarizeRetired(const RetiredProcess& r) {
+    ProcessSummary summary;
+    summary.name = r.name;
+    summary.pid = r.pid;
+    summary.state = FINISHED;
+    summary.currentLine = r.totalLines;
+    summary.totalLines = r.totalLines;
+    summary.coreAssigned = -1;
+    summary.finishTime = r.finishTime;
+    return summary;
+}
+
+/* Fills detail for a retired process with its log reference; the caller
+   reads the events back from the spill files. Returns false when pid is not
+   retired. */
+bool Scheduler::GetRetiredDetail(int pid, ProcessDetail& detail) {
+    if (pid < 0 || pid >= static_cast<int>(pidIndex.size()) || pidIndex[pid].retired < 0) return false;
+
+    const RetiredProcess& r = retired[pidIndex[pid].retired];
+    detail.summary = SummarizeRetired(r);
+    detail.log = r.log;
+    detail.spill = logSpill.IsOpen() ? &logSpill : nullptr;
+    detail.coreHistory = r.coreHistory;
+    return true;
+}
+
+/* True while any process is on a core, ready or sleeping, or a generated
+   one is due but not built yet. Lets headless runs
+   stop once the workload has drained without scanning every process. */
+bool Scheduler::HasPendingWork() const {
+    return GetCoresUsed() > 0 || !policy->Empty() || sleepQueue.Size() > 0 || generationDue > 0;
 }
 
 /* Returns the number of idle CPU cores.
@@ -328,30 +982,80 @@ double Scheduler::GetCPUUtilization() const {
     return (static_cast<double>(GetCoresUsed()) / numCPU) * 100.0;
 }
 
-/* Returns all processes that haven't finished execution yet (READY, RUNNING, or WAITING).
-   Used by Console::ListScreens() and Console::ReportUtil() to display active processes. */
+/* Returns all processes that haven't finished execution yet: those on a core
+   first, then the ready and the sleeping ones. Read from the state lists, so
+   the cost is the size of the answer, not the process table. */
 vector<Process*> Scheduler::GetRunningProcesses() const {
     vector<Process*> running;
-    for (auto proc : allProcesses) {
-        if (!proc->IsFinished()) {
-            running.push_back(proc);
-        }
-    }
+    running.reserve(stateLists[RUNNING].Size() + stateLists[READY].Size() + stateLists[WAITING].Size());
+    stateLists[RUNNING].Collect(running);
+    stateLists[READY].Collect(running);
+    stateLists[WAITING].Collect(running);
     return running;
 }
 
-/* Returns all processes that have completed execution.
-   Used by Console::ListScreens() and Console::ReportUtil() to display finished processes. */
+/* Returns all processes that have completed execution, in completion order. */
 vector<Process*> Scheduler::GetFinishedProcesses() const {
     vector<Process*> finished;
-    for (auto proc : allProcesses) {
-        if (proc->IsFinished()) {
-            finished.push_back(proc);
-        }
-    }
+    stateLists[FINISHED].Collect(finished);
     return finished;
 }
 
+/* Moves a process to the state list matching its current state. Called after
+   every transition the scheduler makes or observes; O(1), and a no-op when
+   the process is already on the right list. */
+void Scheduler::TrackState(Process* proc) {
+    int source = proc->GetStateLink().list;
+    int target = proc->GetState();
+    if (source == target) return;
+
+    if (source >= 0) {
+        stateLists[source].Remove(proc);
+        stateChanges[source]++;
+    }
+    stateLists[target].PushBack(proc);
+    stateChanges[target]++;
+}
+
+/* Puts a process on a core (or clears it with nullptr) and keeps the
+   cores-used count and the process's core history in step. */
+void Scheduler::SetCore(int coreId, Process* proc) {
+    Process*& slot = coreAssignments[coreId];
+    coresUsed += (proc != nullptr) - (slot != nullptr);
+    slot = proc;
+    if (proc != nullptr) {
+        proc->RecordCore(coreId);
+    }
+}
+
+/* Replaces every process that finished at least retire-after ticks ago with
+   a RetiredProcess and frees it. The finished list is in completion order,
+   so the pass stops at the first process that is still too young. Their
+   summaries already sit in the sealed snapshot chunks, so screen -ls and
+   report-util do not notice; screen -r reads the retired record. */
+void Scheduler::RetireFinished() {
+    ProcessList& finished = stateLists[FINISHED];
+    if (finished.Empty() || finished.Front()->GetFinishTick() + config.retireAfter > cpuTicks) return;
+
+    vector<Process*> retirees;
+    while (!finished.Empty() && finished.Front()->GetFinishTick() + config.retireAfter <= cpuTicks) {
+        Process* proc = finished.Front();
+        finished.Remove(proc);
+        pidIndex[proc->GetPID()].live = nullptr;
+        retirees.push_back(proc);
+    }
+
+    auto gone = [this](Process* proc) { return pidIndex[proc->GetPID()].live == nullptr; };
+    allProcesses.erase(remove_if(allProcesses.begin(), allProcesses.end(), gone), allProcesses.end());
+
+    for (auto proc : retirees) {
+        pidIndex[proc->GetPID()].retired = static_cast<int32_t>(retired.size());
+        retired.emplace_back();
+        proc->Retire(retired.back());
+        processPool.Destroy(proc);
+    }
+}
+
 bool Scheduler::TryAssignProcess(Process* proc) {
     if (proc == nullptr) return false;
     if (proc->IsFinished()) return false;
@@ -362,26 +1066,585 @@ bool Scheduler::TryAssignProcess(Process* proc) {
     // look for an idle core
     for (int i = 0; i < numCPU; ++i) {
         if (coreAssignments[i] == nullptr) {
+            // A queued process leaves the queue, so it never holds two cores
+            // and cannot be left queued after it is retired
+            policy->Remove(proc);
             proc->SetState(RUNNING);
             proc->SetCoreAssigned(i);
-            coreAssignments[i] = proc;
+            SetCore(i, proc);
+            TrackState(proc);
 
-            if (type == ROUND_ROBIN) {
-                processQuantumCounters[proc] = 0;
+            if (policy->UsesQuantum()) {
+                coreQuantum[i] = 0;
             }
             return true;
         }
     }
-    bool alreadyQueued = false;
-    std::queue<Process*> tmp;
-    while (!readyQueue.empty()) {
-        Process* p = readyQueue.front(); readyQueue.pop();
-        if (p == proc) alreadyQueued = true;
-        tmp.push(p);
+    if (!policy->Contains(proc)) policy->Push(proc, -1);
+
+    return false;
+}
+
+/* Queues a command for the tick thread. It runs at the start of the next
+   tick, so console requests (screen -s, process-smi, snapshots) never touch
+   scheduler state while a tick is in progress. Callers that need the
+   result wait on their own promise (see Console::RunOnTick()). */
+void Scheduler::Post(function<void()> command) {
+    {
+        lock_guard<mutex> guard(commandLock);
+        commands.push_back(move(command));
+        hasCommands.store(true, memory_order_release);
     }
-    while (!tmp.empty()) { readyQueue.push(tmp.front()); tmp.pop(); }
+    commandPosted.notify_one();
+}
 
-    if (!alreadyQueued) readyQueue.push(proc);
+/* Blocks the tick thread until a command is posted or Wake() is called.
+   Used while CountIdleTicks() says nothing is pending at all. */
+void Scheduler::WaitForCommand() {
+    unique_lock<mutex> guard(commandLock);
+    commandPosted.wait(guard, [this] { return hasCommands.load(memory_order_relaxed) || wakeRequested; });
+    wakeRequested = false;
+}
 
-    return false;
+/* Same, but also returns at until, the host time of the next event. */
+void Scheduler::WaitForCommand(chrono::steady_clock::time_point until) {
+    unique_lock<mutex> guard(commandLock);
+    commandPosted.wait_until(guard, until, [this] { return hasCommands.load(memory_order_relaxed) || wakeRequested; });
+    wakeRequested = false;
+}
+
+/* Ends a WaitForCommand() early, or the next one if none is in progress.
+   Called by the console before it joins the tick thread. */
+void Scheduler::Wake() {
+    {
+        lock_guard<mutex> guard(commandLock);
+        wakeRequested = true;
+    }
+    commandPosted.notify_all();
+}
+
+/* Runs the queued commands now instead of at the start of the next tick.
+   Called by the tick loop while it waits for a deadline, so a console read
+   does not wait out a whole tick period. */
+void Scheduler::ServeCommands() {
+    if (hasCommands.load(memory_order_acquire)) {
+        RunCommands();
+    }
+}
+
+/* Runs every queued command on the tick thread. The lock is held only to
+   take the list, never while a command runs. */
+void Scheduler::RunCommands() {
+    vector<function<void()>> pending;
+    {
+        lock_guard<mutex> guard(commandLock);
+        pending.swap(commands);
+        hasCommands.store(false, memory_order_relaxed);
+    }
+
+    for (auto& command : pending) {
+        command();
+        commandSerial++;
+    }
+}
+
+/* Moves the summaries of newly finished processes into the shared chunks.
+   A small last chunk is replaced by a merged copy rather than appended to,
+   since older snapshots may still be reading it. */
+void Scheduler::SealFinished() {
+    static const size_t CHUNK_SIZE = 1024;
+    if (pendingFinished.empty()) return;
+
+    if (!finishedChunks.empty() && finishedChunks.back()->size() < CHUNK_SIZE) {
+        auto merged = make_shared<vector<ProcessSummary>>(*finishedChunks.back());
+        merged->insert(merged->end(), pendingFinished.begin(), pendingFinished.end());
+        finishedChunks.back() = merged;
+    } else {
+        finishedChunks.push_back(make_shared<const vector<ProcessSummary>>(pendingFinished));
+    }
+    pendingFinished.clear();
+}
+
+/* Builds an immutable snapshot of the scheduler and publishes it with an
+   atomic pointer swap. Must run on the tick thread (or with ticks stopped).
+   Only what changed is copied: the processes on a core (their line moves
+   every tick), and the ready or sleeping list when a process entered or
+   left it since the last publish. The other chunks are shared with the
+   previous snapshot. Repeated requests within one tick reuse the snapshot
+   already built. */
+void Scheduler::PublishSnapshot() {
+    if (snapshotVersion > 0 && snapshotTick == cpuTicks && snapshotSerial == commandSerial) {
+        return;
+    }
+
+    SealFinished();
+
+    vector<Process*> procs;
+    for (int state = READY; state < FINISHED; state++) {
+        if (state != RUNNING && stateChunks[state] && chunkChanges[state] == stateChanges[state]) continue;
+
+        procs.clear();
+        stateLists[state].Collect(procs);
+        auto chunk = make_shared<vector<ProcessSummary>>();
+        chunk->reserve(procs.size());
+        for (auto proc : procs) {
+            chunk->push_back(proc->GetSummary());
+        }
+        stateChunks[state] = move(chunk);
+        chunkChanges[state] = stateChanges[state];
+    }
+
+    auto next = make_shared<SchedulerSnapshot>();
+    next->version = ++snapshotVersion;
+    next->cpuTicks = cpuTicks;
+    next->numCPU = numCPU;
+    next->coresUsed = coresUsed;
+    next->cpuUtilization = GetCPUUtilization();
+    for (int state = READY; state < FINISHED; state++) {
+        next->unfinished[state] = stateChunks[state];
+    }
+    next->finished = finishedChunks;
+    next->finishedCount = stateLists[FINISHED].Size() + retired.size();
+
+    snapshotTick = cpuTicks;
+    snapshotSerial = commandSerial;
+    atomic_store(&snapshot, shared_ptr<const SchedulerSnapshot>(move(next)));
+}
+
+/* Removes every process and empties the queues, cores and timing wheel, and
+   stops the producers. Used by LoadCheckpoint() before rebuilding the
+   restored state. */
+void Scheduler::ClearProcesses() {
+    producer.Shutdown();
+    generationOrders.clear();
+    generationDue = 0;
+    for (auto proc : allProcesses) {
+        processPool.Destroy(proc);
+    }
+    allProcesses.clear();
+    nameIndex.clear();
+    pidIndex.clear();
+    retired.clear();
+    for (int i = READY; i <= FINISHED; i++) {
+        stateLists[i].Clear();
+        stateChanges[i]++;
+    }
+    finishedChunks.clear();
+    pendingFinished.clear();
+    commandSerial++;
+    policy->Clear();
+    sleepQueue.Reset(static_cast<unsigned long long>(cpuTicks));
+    for (int i = 0; i < numCPU; i++) {
+        coreAssignments[i] = nullptr;
+    }
+    coreQuantum.assign(numCPU, 0);
+    sliceRetryTick = 0;
+    coresUsed = 0;
+}
+
+/* Writes the whole scheduler state to a binary checkpoint (format in
+   checkpoint.h): every process with its program, variables, loop state and
+   log, plus ready queue and state list order, core assignments, quantum
+   counters, sleepers and the tick count. Program ops and log events are streamed process by
+   process, so memory use stays flat however many processes there are.
+   The tick thread must be paused (Console::Checkpoint() does this). */
+bool Scheduler::SaveCheckpoint(const string& fileName, string& error) {
+    CheckpointWriter writer;
+    if (!writer.Open(fileName)) {
+        error = "cannot create " + fileName;
+        return false;
+    }
+
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    header.cpuTicks = cpuTicks;
+    header.processCounter = processCounter;
+    header.currentPID = currentPID;
+    header.numCPU = numCPU;
+    header.isRunning = isRunning ? 1 : 0;
+    header.seed = masterSeed;
+    header.pushCursor = policy->GetPushCursor();
+    header.generationDue = generationDue;
+
+    // Message templates as [length][bytes]
+    vector<string> messages = MessageTable::GetAll();
+    header.messages.offset = writer.BeginSection();
+    header.messages.count = messages.size();
+    for (const auto& text : messages) {
+        uint32_t length = static_cast<uint32_t>(text.size());
+        writer.Append(&length, sizeof(length));
+        writer.Append(text.data(), length);
+    }
+
+    // Records, names and variables are small; build them while streaming the ops
+    vector<ProcessRecord> records(allProcesses.size());
+    vector<RetiredRecord> retiredRecords(retired.size());
+    vector<uint16_t> variables;
+    vector<uint16_t> coreHistory;
+    string names;
+
+    header.ops.offset = writer.BeginSection();
+    uint64_t opTotal = 0;
+    for (size_t i = 0; i < allProcesses.size(); i++) {
+        Process* proc = allProcesses[i];
+        ProcessRecord& record = records[i];
+        memset(&record, 0, sizeof(record));
+        proc->SaveState(record, variables, coreHistory);
+
+        string name = proc->GetName();
+        record.nameOffset = names.size();
+        record.nameLength = static_cast<uint32_t>(name.size());
+        names += name;
+
+        int core = proc->GetCoreAssigned();
+        bool onCore = core >= 0 && core < numCPU && coreAssignments[core] == proc;
+        record.quantumCounter = onCore ? coreQuantum[core] : 0;
+
+        const Program& program = proc->GetProgram();
+        record.opIndex = opTotal;
+        writer.Append(program.ops.data(), program.ops.size() * sizeof(Op));
+        writer.Append(program.loopBodies.data(), program.loopBodies.size() * sizeof(Op));
+        opTotal += program.ops.size() + program.loopBodies.size();
+    }
+    header.ops.count = opTotal;
+
+    header.events.offset = writer.BeginSection();
+    uint64_t eventTotal = 0;
+    vector<LogEvent> events;
+    for (size_t i = 0; i < allProcesses.size(); i++) {
+        events.clear();
+        allProcesses[i]->GetLog().Collect(events);
+        records[i].eventIndex = eventTotal;
+        records[i].eventCount = events.size();
+        writer.Append(events.data(), events.size() * sizeof(LogEvent));
+        eventTotal += events.size();
+    }
+    LogSpill* spill = logSpill.IsOpen() ? &logSpill : nullptr;
+    for (size_t i = 0; i < retired.size(); i++) {
+        const RetiredProcess& r = retired[i];
+        RetiredRecord& record = retiredRecords[i];
+        memset(&record, 0, sizeof(record));
+
+        events.clear();
+        CollectLogEvents(r.log, spill, events);
+        record.eventIndex = eventTotal;
+        record.eventCount = events.size();
+        writer.Append(events.data(), events.size() * sizeof(LogEvent));
+        eventTotal += events.size();
+
+        string name = r.name.ToString();
+        record.nameOffset = names.size();
+        record.nameLength = static_cast<uint32_t>(name.size());
+        names += name;
+
+        record.finishTime = static_cast<int64_t>(r.finishTime);
+        record.droppedCount = r.log.droppedCount;
+        record.coreIndex = coreHistory.size();
+        record.coreCount = static_cast<uint32_t>(r.coreHistory.size());
+        coreHistory.insert(coreHistory.end(), r.coreHistory.begin(), r.coreHistory.end());
+        record.pid = r.pid;
+        record.totalLines = r.totalLines;
+    }
+    header.events.count = eventTotal;
+
+    header.names = writer.Write(names.data(), names.size(), names.size());
+    header.processes = writer.WriteArray(records);
+    header.variables = writer.WriteArray(variables);
+
+    vector<QueueRecord> queued;
+    vector<Process*> queueItems;
+    for (int q = 0; q < policy->GetQueueCount(); q++) {
+        queueItems.clear();
+        policy->Collect(q, queueItems);
+        for (auto proc : queueItems) {
+            queued.push_back({ q, proc->GetPID() });
+        }
+    }
+    header.queues = writer.WriteArray(queued);
+
+    vector<int32_t> cores(numCPU, -1);
+    for (int i = 0; i < numCPU; i++) {
+        if (coreAssignments[i] != nullptr) {
+            cores[i] = coreAssignments[i]->GetPID();
+        }
+    }
+    header.cores = writer.WriteArray(cores);
+
+    vector<pair<Process*, unsigned long long>> sleeping;
+    sleepQueue.Collect(sleeping);
+    vector<SleepRecord> sleepers;
+    for (const auto& entry : sleeping) {
+        SleepRecord record;
+        record.pid = entry.first->GetPID();
+        record.padding = 0;
+        record.wakeTick = entry.second;
+        sleepers.push_back(record);
+    }
+    header.sleepers = writer.WriteArray(sleepers);
+    header.retired = writer.WriteArray(retiredRecords);
+    header.coreHistory = writer.WriteArray(coreHistory);
+
+    vector<OrderRecord> orders;
+    for (const auto& order : generationOrders) {
+        OrderRecord record;
+        record.sequence = order.sequence;
+        record.pid = order.pid;
+        record.numInstructions = order.numInstructions;
+        record.priority = order.priority;
+        record.padding = 0;
+        orders.push_back(record);
+    }
+    header.orders = writer.WriteArray(orders);
+
+    vector<int32_t> states;
+    vector<Process*> listed;
+    for (const auto& list : stateLists) {
+        listed.clear();
+        list.Collect(listed);
+        for (auto proc : listed) {
+            states.push_back(proc->GetPID());
+        }
+    }
+    header.states = writer.WriteArray(states);
+
+    if (!writer.Finish(header)) {
+        error = "write to " + fileName + " failed";
+        return false;
+    }
+    return true;
+}
+
+/* Replaces the current state with a checkpoint written by SaveCheckpoint().
+   The file is memory-mapped and the records are used in place: ops,
+   variables and log events are bulk-copied into each process, with message
+   ids remapped to this run's MessageTable. Everything is validated before
+   the current processes are dropped, so a bad file leaves the scheduler as
+   it was. The checkpoint must come from a run with the same num-cpu. */
+bool Scheduler::LoadCheckpoint(const string& fileName, string& error) {
+    CheckpointReader reader;
+    if (!reader.Open(fileName, error)) {
+        return false;
+    }
+    const CheckpointHeader& header = *reader.GetHeader();
+
+    if (header.numCPU != numCPU) {
+        error = "checkpoint has " + to_string(header.numCPU) + " CPUs, this system has " + to_string(numCPU);
+        return false;
+    }
+    if (header.currentPID < 1 || header.currentPID > INT32_MAX || header.cpuTicks < 0 || header.cpuTicks > INT32_MAX) {
+        error = "checkpoint header is corrupt";
+        return false;
+    }
+
+    // Message table: old id -> id in this run
+    vector<uint32_t> messageMap;
+    uint64_t cursor = header.messages.offset;
+    for (uint64_t i = 0; i < header.messages.count; i++) {
+        const char* lengthBytes = reader.GetBytes(cursor, sizeof(uint32_t));
+        if (lengthBytes == nullptr) break;
+        uint32_t length;
+        memcpy(&length, lengthBytes, sizeof(length));
+        const char* text = reader.GetBytes(cursor + sizeof(uint32_t), length);
+        if (text == nullptr) break;
+        messageMap.push_back(MessageTable::Intern(string(text, length)));
+        cursor += sizeof(uint32_t) + length;
+    }
+
+    const char* names = reader.Section<char>(header.names);
+    const ProcessRecord* records = reader.Section<ProcessRecord>(header.processes);
+    const Op* ops = reader.Section<Op>(header.ops);
+    const uint16_t* variables = reader.Section<uint16_t>(header.variables);
+    const LogEvent* events = reader.Section<LogEvent>(header.events);
+    const QueueRecord* queued = reader.Section<QueueRecord>(header.queues);
+    const int32_t* cores = reader.Section<int32_t>(header.cores);
+    const SleepRecord* sleepers = reader.Section<SleepRecord>(header.sleepers);
+    const RetiredRecord* retiredRecords = reader.Section<RetiredRecord>(header.retired);
+    const uint16_t* coreHistory = reader.Section<uint16_t>(header.coreHistory);
+    const OrderRecord* orders = reader.Section<OrderRecord>(header.orders);
+    const int32_t* states = reader.Section<int32_t>(header.states);
+
+    if (messageMap.size() != header.messages.count || names == nullptr || records == nullptr || ops == nullptr ||
+        variables == nullptr || events == nullptr || queued == nullptr || cores == nullptr || sleepers == nullptr ||
+        retiredRecords == nullptr || coreHistory == nullptr || orders == nullptr || states == nullptr || header.cores.count != static_cast<uint64_t>(numCPU)) {
+        error = "checkpoint sections are corrupt";
+        return false;
+    }
+
+    // currentPID sizes the pid tables, so check it against the records first.
+    // Every smaller pid went to a record, or to a generated process dropped
+    // because a record already had its name, so it can pass the highest
+    // recorded pid by at most the number of records
+    int64_t highestPID = 0;
+    for (uint64_t i = 0; i < header.processes.count; i++) {
+        highestPID = max(highestPID, static_cast<int64_t>(records[i].pid));
+    }
+    for (uint64_t i = 0; i < header.retired.count; i++) {
+        highestPID = max(highestPID, static_cast<int64_t>(retiredRecords[i].pid));
+    }
+    for (uint64_t i = 0; i < header.orders.count; i++) {
+        highestPID = max(highestPID, static_cast<int64_t>(orders[i].pid));
+    }
+    uint64_t recordCount = header.processes.count + header.retired.count + header.orders.count;
+    if (header.currentPID <= highestPID || static_cast<uint64_t>(header.currentPID - highestPID - 1) > recordCount) {
+        error = "checkpoint header is corrupt";
+        return false;
+    }
+
+    // Every reference must stay inside its section and every pid must be unique
+    int maxPID = static_cast<int>(header.currentPID);
+    vector<bool> seen(maxPID, false);
+    for (uint64_t i = 0; i < header.processes.count; i++) {
+        const ProcessRecord& r = records[i];
+        bool valid = r.pid > 0 && r.pid < maxPID && !seen[r.pid] &&
+            r.nameOffset + r.nameLength <= header.names.count &&
+            r.opIndex + r.opCount + r.bodyCount <= header.ops.count &&
+            r.varIndex + r.varCount <= header.variables.count &&
+            r.eventIndex + r.eventCount <= header.events.count &&
+            r.coreIndex + r.coreCount <= header.coreHistory.count &&
+            r.state >= READY && r.state <= FINISHED &&
+            (r.backend == BACKEND_BYTECODE || r.backend == BACKEND_OBJECTS) &&
+            r.currentLine >= 0 && r.currentLine <= r.totalLines &&
+            r.windowStart >= 0 && r.currentLine - r.windowStart <= static_cast<int64_t>(r.opCount) &&
+            (r.lazyWindow > 0 || r.opCount == static_cast<uint32_t>(r.totalLines));
+        if (!valid) {
+            error = "process record " + to_string(i) + " is corrupt";
+            return false;
+        }
+        seen[r.pid] = true;
+    }
+    for (uint64_t i = 0; i < header.retired.count; i++) {
+        const RetiredRecord& r = retiredRecords[i];
+        bool valid = r.pid > 0 && r.pid < maxPID && !seen[r.pid] &&
+            r.nameOffset + r.nameLength <= header.names.count &&
+            r.eventIndex + r.eventCount <= header.events.count &&
+            r.coreIndex + r.coreCount <= header.coreHistory.count &&
+            r.totalLines >= 0;
+        if (!valid) {
+            error = "retired record " + to_string(i) + " is corrupt";
+            return false;
+        }
+        seen[r.pid] = true;
+    }
+    for (uint64_t i = 0; i < header.orders.count; i++) {
+        const OrderRecord& r = orders[i];
+        if (r.pid <= 0 || r.pid >= maxPID || seen[r.pid] || r.numInstructions < 0 ||
+            r.sequence < 0 || r.sequence >= header.processCounter) {
+            error = "generation order " + to_string(i) + " is corrupt";
+            return false;
+        }
+        seen[r.pid] = true;
+    }
+
+    ClearProcesses();
+    metrics.Reset();
+    cpuTicks = static_cast<int>(header.cpuTicks);
+    processCounter = static_cast<int>(header.processCounter);
+    currentPID = maxPID;
+    isRunning = header.isRunning != 0;
+    masterSeed = header.seed;
+    programOptions.seed = masterSeed;
+    SimClock::SetTick(cpuTicks);
+    sleepQueue.Reset(static_cast<unsigned long long>(cpuTicks));
+
+    allProcesses.reserve(header.processes.count);
+    pidIndex.assign(maxPID, PidEntry());
+    for (uint64_t i = 0; i < header.processes.count; i++) {
+        const ProcessRecord& r = records[i];
+        ProcessName name(string(names + r.nameOffset, r.nameLength));
+
+        Process* proc = processPool.Create(name, r.pid, 0, delaysPerExec, programOptions);
+        proc->RestoreState(r, ops + r.opIndex, variables + r.varIndex, coreHistory + r.coreIndex,
+            events + r.eventIndex, messageMap);
+
+        allProcesses.push_back(proc);
+        nameIndex.emplace(name, r.pid);
+        pidIndex[r.pid].live = proc;
+    }
+
+    auto lookup = [this](int32_t pid) -> Process* {
+        return (pid > 0 && pid < static_cast<int>(pidIndex.size())) ? pidIndex[pid].live : nullptr;
+    };
+
+    // The state lists go back in their saved order: listings look the same as
+    // before the checkpoint, and the finished list stays in completion order,
+    // which RetireFinished() relies on
+    for (uint64_t i = 0; i < header.states.count; i++) {
+        Process* proc = lookup(states[i]);
+        if (proc != nullptr && proc->GetStateLink().list == -1) {
+            TrackState(proc);
+        }
+    }
+    for (auto proc : allProcesses) {
+        if (proc->GetStateLink().list == -1) {
+            TrackState(proc);
+        }
+    }
+    vector<Process*> finished;
+    stateLists[FINISHED].Collect(finished);
+    for (auto proc : finished) {
+        pendingFinished.push_back(proc->GetSummary());
+    }
+
+    // Retired logs go straight back to the spill files
+    LogSpill* spill = logSpill.IsOpen() ? &logSpill : nullptr;
+    retired.resize(header.retired.count);
+    vector<LogEvent> retiredEvents;
+    vector<ProcessSummary> retiredSummaries;
+    for (uint64_t i = 0; i < header.retired.count; i++) {
+        const RetiredRecord& r = retiredRecords[i];
+        RetiredProcess& entry = retired[i];
+        entry.name = ProcessName(string(names + r.nameOffset, r.nameLength));
+        entry.pid = r.pid;
+        entry.totalLines = r.totalLines;
+        entry.finishTime = static_cast<time_t>(r.finishTime);
+        entry.coreHistory.assign(coreHistory + r.coreIndex, coreHistory + r.coreIndex + r.coreCount);
+        entry.log.droppedCount = r.droppedCount;
+
+        retiredEvents.assign(events + r.eventIndex, events + r.eventIndex + r.eventCount);
+        for (auto& event : retiredEvents) {
+            if (event.messageId < messageMap.size()) event.messageId = messageMap[event.messageId];
+        }
+        StoreLogEvents(retiredEvents.data(), retiredEvents.size(), spill, entry.log);
+
+        nameIndex.emplace(entry.name, r.pid);
+        pidIndex[r.pid].retired = static_cast<int32_t>(i);
+
+        retiredSummaries.push_back(SummarizeRetired(entry));
+    }
+    // Retired processes finished before the live finished ones
+    pendingFinished.insert(pendingFinished.begin(), retiredSummaries.begin(), retiredSummaries.end());
+
+    policy->OnRestore(cpuTicks);
+    policy->SetPushCursor(header.pushCursor);
+    for (uint64_t i = 0; i < header.queues.count; i++) {
+        Process* proc = lookup(queued[i].pid);
+        if (proc != nullptr) policy->Push(proc, queued[i].queue);
+    }
+    for (int i = 0; i < numCPU; i++) {
+        SetCore(i, lookup(cores[i]));
+    }
+    for (uint64_t i = 0; i < header.processes.count; i++) {
+        Process* proc = lookup(records[i].pid);
+        int core = (proc != nullptr) ? proc->GetCoreAssigned() : -1;
+        if (core >= 0 && core < numCPU && coreAssignments[core] == proc) {
+            coreQuantum[core] = records[i].quantumCounter;
+        }
+    }
+    for (uint64_t i = 0; i < header.sleepers.count; i++) {
+        Process* proc = lookup(sleepers[i].pid);
+        if (proc != nullptr) sleepQueue.Schedule(proc, sleepers[i].wakeTick);
+    }
+
+    // Processes that were ordered but not generated yet are built again
+    for (uint64_t i = 0; i < header.orders.count; i++) {
+        ProcessOrder order;
+        order.sequence = orders[i].sequence;
+        order.pid = orders[i].pid;
+        order.numInstructions = orders[i].numInstructions;
+        order.priority = orders[i].priority;
+        generationOrders.push_back(order);
+    }
+    generationDue = max(0, min(header.generationDue, static_cast<int32_t>(generationOrders.size())));
+    StartProducer();
+    return true;
 }
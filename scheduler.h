@@ -4,24 +4,58 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
 #include "process.h"
+#include "processname.h"
+#include "processpool.h"
+#include "workerpool.h"
+#include "runqueue.h"
+#include "policy.h"
+#include "timerwheel.h"
+#include "outputlog.h"
+#include "metrics.h"
+#include "snapshot.h"
+#include "processlist.h"
+#include "producer.h"
 
 using namespace std;
 
-enum SchedulerType {
-    FCFS,
-    ROUND_ROBIN
-};
-
 struct Config {
     int numCPU = 4;
     SchedulerType type = ROUND_ROBIN;
     int quantumCycles = 5;
     int batchProcessFreq = 1;
+    int batchSize = 1;           // processes generated every batch-process-freq ticks
+    int generatorThreads = 1;    // producer threads building them ahead, 0 = build inside the tick
     int minIns = 1000;
     int maxIns = 2000;
     int delaysPerExec = 0;
+    int workerThreads = 0;
+    RunQueueMode runQueueMode = PER_CORE;
+    ExecBackend execBackend = BACKEND_BYTECODE;
+    int lazyWindow = 0;
+    bool optimizePrograms = true;
+    int logRingSize = 64;
+    string logSpillDir = ".";    // "none" drops old log entries instead
+    bool metrics = true;
+    int tickBudgetMs = 100;
+    double tickRate = 10;        // interactive ticks per second, 0 = as fast as possible
+    bool slicedExecution = false; // run quiet stretches as one slice per core (see RunSlice)
+    string statsFile = "";       // empty = no periodic stats file
+    int statsInterval = 600;     // ticks between stats file rewrites
+    int priorityLevels = 8;      // PRIORITY: priorities drawn from 0 (highest) .. levels-1
+    int mlfqLevels = 3;
+    int mlfqBoostInterval = 1000;    // ticks between MLFQ priority boosts, 0 = never
+    long long seed = -1;         // master seed for generated workloads, -1 = from the clock
+    int retireAfter = 600;       // ticks a finished process stays live before it is retired, -1 = never
 };
 
 class Scheduler {
@@ -33,12 +67,64 @@ private:
     int minIns;
     int maxIns;
     int delaysPerExec;
-
-    queue<Process*> readyQueue;
+    int workerThreads;
+    uint64_t masterSeed;
+    ProgramOptions programOptions;
+    LogSpill logSpill;
+    TickMetrics metrics;
+
+    unique_ptr<SchedulingPolicy> policy;
+    TimerWheel sleepQueue;
+    vector<Process*> wokenProcesses;
     vector<Process*> runningProcesses;
     vector<Process*> allProcesses;
+    ProcessPool processPool;
+    ProcessProducer producer;
+    deque<ProcessOrder> generationOrders;   // submitted to the producer, not yet taken
+    int generationDue;                      // leading orders already due, waiting on a producer
+    bool deferGeneration;                   // interactive ticks: do not wait for a producer
     map<int, Process*> coreAssignments;
-    map<Process*, int> processQuantumCounters;
+    vector<int> coreQuantum;    // quantum ticks used by the process on each core
+    long long sliceRetryTick;   // no slice fits before the event a refused RunSlice() found
+
+    // Processes grouped by state, indexed by ProcessState, plus a live count
+    // of occupied cores; kept current on every transition so the console
+    // queries never scan allProcesses or coreAssignments
+    ProcessList stateLists[FINISHED + 1];
+    unsigned long long stateChanges[FINISHED + 1];  // bumped when a process enters or leaves the list
+    int coresUsed;
+
+    // O(1) lookups: name -> pid, pid -> live process or retired record
+    struct PidEntry {
+        Process* live = nullptr;
+        int32_t retired = -1;
+    };
+    unordered_map<ProcessName, int, ProcessNameHash> nameIndex;
+    vector<PidEntry> pidIndex;
+
+    // Finished processes past retire-after, in retirement order
+    vector<RetiredProcess> retired;
+
+    WorkerPool workers;
+    vector<vector<pair<int, Process*>>> slotCores;
+
+    // Console -> tick thread mailbox, drained at the start of every tick
+    mutex commandLock;
+    condition_variable commandPosted;   // wakes a tick thread sleeping through idle ticks
+    vector<function<void()>> commands;
+    atomic<bool> hasCommands;
+    bool wakeRequested;
+    unsigned long long commandSerial;
+
+    // Published state for console reads (see PublishSnapshot)
+    shared_ptr<const SchedulerSnapshot> snapshot;
+    unsigned long long snapshotVersion;
+    int snapshotTick;
+    unsigned long long snapshotSerial;
+    SummaryChunk stateChunks[FINISHED];     // last published summaries of each unfinished state
+    unsigned long long chunkChanges[FINISHED];  // stateChanges when each chunk was built
+    vector<SummaryChunk> finishedChunks;
+    vector<ProcessSummary> pendingFinished;
 
     int currentPID;
     int cpuTicks;
@@ -49,31 +135,86 @@ private:
 
     void LoadConfig(const string& filename);
     void ScheduleNext(int coreId);
+    void RunCores();
+    bool ExecuteCoresParallel(int sliceTicks);
+    void CompleteStep(int coreId);
+    void WakeSleepers();
+    long long NextEventTick() const;
+    int SliceLength(int maxTicks) const;
+    void DispatchIdleCores();
+    void PreemptForBetter();
+    void CreatePolicy();
+    void WriteStatsFile();
+    void ClearProcesses();
+    void RunCommands();
+    void SealFinished();
+    void TrackState(Process* proc);
+    void SetCore(int coreId, Process* proc);
+    void RetireFinished();
+    void StartProducer();
+    ProcessOrder MakeOrder();
+    void DrawWorkload(int pid, int& numInstructions, int& priority) const;
+    void OrderProcesses();
+    void GenerateBatch();
+    void AdmitGenerated();
+    void AdmitProcess(Process* proc);
 
 public:
     Scheduler();
     ~Scheduler();
 
     void Initialize(const string& configFile);
+    void Initialize(const Config& settings);
     void Tick();
+    long long CountIdleTicks() const;
+    long long SkipTicks(long long count);
+    int RunSlice(int maxTicks);
     void Start();
     void Stop();
 
     void CreateNewProcess(const string& name);
+    void CreateNewProcess(const ProcessName& name);
     Process* GetProcess(const string& name);
+    Process* GetProcessByPID(int pid) const;
     vector<Process*> GetAllProcesses() const { return allProcesses; }
+    int FindPID(const string& name) const;
+    bool GetRetiredDetail(int pid, ProcessDetail& detail);
+    size_t GetRetiredCount() const { return retired.size(); }
 
     int GetNumCPU() const { return numCPU; }
+    int GetWorkerThreads() const { return workers.GetSlotCount(); }
+    int GetGeneratorThreads() const { return producer.GetThreadCount(); }
     int GetCPUTicks() const { return cpuTicks; }
+    uint64_t GetSeed() const { return masterSeed; }
+    double GetTickRate() const { return config.tickRate; }
+    bool IsSliced() const { return config.slicedExecution; }
+    void SetDeferGeneration(bool defer) { deferGeneration = defer; }
     bool IsRunning() const { return isRunning; }
-    int GetCoresUsed() const;
+    int GetCoresUsed() const { return coresUsed; }
+    bool HasPendingWork() const;
+    size_t GetSleepingCount() const { return sleepQueue.Size(); }
+    SchedulerType GetType() const { return type; }
+    const SchedulingPolicy& GetPolicy() const { return *policy; }
+    const TickMetrics& GetMetrics() const { return metrics; }
     int GetCoresAvailable() const;
     double GetCPUUtilization() const;
 
     vector<Process*> GetRunningProcesses() const;
     vector<Process*> GetFinishedProcesses() const;
+    size_t GetStateCount(ProcessState state) const { return stateLists[state].Size(); }
 
     bool TryAssignProcess(Process* proc);
+
+    void Post(function<void()> command);
+    void WaitForCommand();
+    void WaitForCommand(chrono::steady_clock::time_point until);
+    void Wake();
+    void ServeCommands();
+    void PublishSnapshot();
+    shared_ptr<const SchedulerSnapshot> GetSnapshot() const { return atomic_load(&snapshot); }
+
+    bool SaveCheckpoint(const string& fileName, string& error);
+    bool LoadCheckpoint(const string& fileName, string& error);
 };
 
 #endif
\ No newline at end of file
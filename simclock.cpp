@@ -0,0 +1,28 @@
+/* Simulated clock shared by the scheduler and process logs */
+
+#include "simclock.h"
+
+using namespace std;
+
+atomic<unsigned long long> SimClock::tick(0);
+atomic<long long> SimClock::virtualBase(0);
+atomic<int> SimClock::msPerTick(100);
+
+/* Switches to virtual time: tick N happens at base + N * tickMs.
+   Called by Console::RunHeadless() before the first tick. */
+void SimClock::UseVirtualTime(time_t base, int tickMs) {
+    msPerTick.store(tickMs > 0 ? tickMs : 1, memory_order_relaxed);
+    virtualBase.store(static_cast<long long>(base), memory_order_relaxed);
+}
+
+/* Wall-clock time of a tick, used for log timestamps, finish times and
+   reports (Now() is the current tick). Host time in interactive mode,
+   tick-derived time in virtual mode. */
+time_t SimClock::TimeAt(unsigned long long atTick) {
+    long long base = virtualBase.load(memory_order_relaxed);
+    if (base == 0) {
+        return time(nullptr);
+    }
+    long long elapsedMs = static_cast<long long>(atTick) * msPerTick.load(memory_order_relaxed);
+    return static_cast<time_t>(base + elapsedMs / 1000);
+}
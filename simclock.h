@@ -0,0 +1,30 @@
+#ifndef SIMCLOCK_H
+#define SIMCLOCK_H
+
+#include <atomic>
+#include <ctime>
+
+using namespace std;
+
+/* Process-wide simulated clock. The scheduler publishes the current CPU tick
+   here so instructions can stamp events without a pointer back to it.
+   In virtual mode (headless runs) wall-clock time is derived from the tick
+   count instead of the host clock, so a fast-forwarded run still produces
+   the timestamps a real-time run would have. */
+class SimClock {
+private:
+    static atomic<unsigned long long> tick;
+    static atomic<long long> virtualBase;
+    static atomic<int> msPerTick;
+
+public:
+    static void SetTick(unsigned long long value) { tick.store(value, memory_order_relaxed); }
+    static unsigned long long GetTick() { return tick.load(memory_order_relaxed); }
+
+    static void UseVirtualTime(time_t base, int tickMs);
+    static bool IsVirtual() { return virtualBase.load(memory_order_relaxed) != 0; }
+    static time_t Now() { return TimeAt(GetTick()); }
+    static time_t TimeAt(unsigned long long atTick);
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <ctime>
+#include "processname.h"
+#include "outputlog.h"
+
+using namespace std;
+
+enum ProcessState {
+    READY,
+    RUNNING,
+    WAITING,
+    FINISHED
+};
+
+/* Read-only copy of the fields screen -ls and report-util show for one process. */
+struct ProcessSummary {
+    ProcessName name;
+    int pid;
+    ProcessState state;
+    int currentLine;
+    int totalLines;
+    int coreAssigned;
+    time_t finishTime;
+};
+
+/* Read-only copy of one process for process-smi. The tick thread only
+   copies the log's ring and spill chain head; the console thread reads the
+   spilled events back (spill records are never rewritten) and formats them. */
+struct ProcessDetail {
+    ProcessSummary summary;
+    LogReference log;
+    LogSpill* spill = nullptr;
+    vector<uint16_t> coreHistory;
+};
+
+/* Summaries shared between snapshots. Finished ones never change, so they
+   are kept in sealed chunks; ready and sleeping ones only change when a
+   process enters or leaves that state, so their chunk is rebuilt then. */
+typedef shared_ptr<const vector<ProcessSummary>> SummaryChunk;
+
+/* Immutable view of the scheduler published by the tick thread. Readers
+   hold a shared_ptr to it, so a snapshot stays valid however long they use
+   it and the tick thread never waits for them. */
+struct SchedulerSnapshot {
+    unsigned long long version = 0;
+    int cpuTicks = 0;
+    int numCPU = 0;
+    int coresUsed = 0;
+    double cpuUtilization = 0.0;
+    SummaryChunk unfinished[FINISHED];  // indexed by ProcessState; see Unfinished() for creation order
+    vector<SummaryChunk> finished;      // finished processes, completion order
+    size_t finishedCount = 0;
+
+    size_t UnfinishedCount() const {
+        return unfinished[READY]->size() + unfinished[RUNNING]->size() + unfinished[WAITING]->size();
+    }
+
+    /* Every unfinished process in creation order, the order allProcesses
+       keeps. PIDs are handed out in creation order, so the chunks are merged
+       by PID here, on the reader's thread rather than the tick thread. */
+    vector<const ProcessSummary*> Unfinished() const {
+        vector<const ProcessSummary*> list;
+        list.reserve(UnfinishedCount());
+        for (const auto& chunk : unfinished) {
+            for (const auto& proc : *chunk) {
+                list.push_back(&proc);
+            }
+        }
+        sort(list.begin(), list.end(), [](const ProcessSummary* a, const ProcessSummary* b) { return a->pid < b->pid; });
+        return list;
+    }
+};
+
+#endif
@@ -0,0 +1,137 @@
+/* Timing wheel for SLEEP: wakes processes without scanning every process */
+
+#include <climits>
+#include "timerwheel.h"
+
+using namespace std;
+
+/* Constructor starts the wheel at tick 0 with no sleepers. */
+TimerWheel::TimerWheel() : now(0), count(0) {}
+
+/* Parks a process until the given tick. Wake ticks in the past or present
+   are moved to the next tick so they still fire. */
+void TimerWheel::Schedule(Process* proc, unsigned long long wakeTick) {
+    if (wakeTick <= now) {
+        wakeTick = now + 1;
+    }
+
+    Entry entry;
+    entry.proc = proc;
+    entry.wakeTick = wakeTick;
+    Place(entry);
+    count++;
+}
+
+/* Puts an entry in the lowest level whose range still reaches its wake tick.
+   Anything beyond the top level's range waits in the top level and gets
+   re-placed each time that slot cascades. */
+void TimerWheel::Place(const Entry& entry) {
+    unsigned long long delta = entry.wakeTick - now;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+
+    int index = static_cast<int>((entry.wakeTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    slots[level][index].push_back(entry);
+}
+
+/* Moves the current slot of a higher level down into the levels below.
+   When that level also wrapped around, the next level is cascaded first. */
+void TimerWheel::Cascade(int level) {
+    int index = static_cast<int>((now >> (SLOT_BITS * level)) & (SLOTS - 1));
+    if (index == 0 && level + 1 < LEVELS) {
+        Cascade(level + 1);
+    }
+
+    vector<Entry> pending;
+    pending.swap(slots[level][index]);
+    for (const auto& entry : pending) {
+        Place(entry);
+    }
+}
+
+/* Advances the wheel up to the given tick and collects every process whose
+   wake tick has been reached. Each step only touches the level 0 slot of that
+   tick (plus a cascade every 64 ticks), so the cost follows the number of
+   wakeups rather than the number of sleeping processes. */
+void TimerWheel::Advance(unsigned long long tick, vector<Process*>& expired) {
+    if (count == 0) {
+        if (tick > now) now = tick;
+        return;
+    }
+
+    while (now < tick) {
+        now++;
+
+        if ((now & (SLOTS - 1)) == 0) {
+            Cascade(1);
+        }
+
+        vector<Entry>& slot = slots[0][now & (SLOTS - 1)];
+        if (slot.empty()) continue;
+
+        vector<Entry> due;
+        due.swap(slot);
+        for (const auto& entry : due) {
+            if (entry.wakeTick <= now) {
+                expired.push_back(entry.proc);
+                count--;
+            } else {
+                Place(entry);
+            }
+        }
+    }
+}
+
+/* Earliest tick at which Advance() can wake someone, never later than the
+   real earliest wake tick; ULLONG_MAX when nobody sleeps. Level 0 holds the
+   next 63 ticks one per slot, so it is exact there. Higher levels are not
+   due before their slot cascades at the next multiple of 64, so when they
+   hold anyone that boundary stands in for them. A level 0 entry before the
+   boundary is the answer whatever the higher levels hold, so the scan
+   usually stops there. */
+unsigned long long TimerWheel::NextExpiry() const {
+    if (count == 0) return ULLONG_MAX;
+
+    unsigned long long boundary = (now | (SLOTS - 1)) + 1;
+    unsigned long long first = ULLONG_MAX;
+    size_t nearby = 0;
+    for (unsigned long long tick = now + 1; tick < now + SLOTS; tick++) {
+        const vector<Entry>& slot = slots[0][tick & (SLOTS - 1)];
+        if (slot.empty()) continue;
+        if (tick < boundary) return tick;
+        if (first == ULLONG_MAX) first = tick;
+        nearby += slot.size();
+    }
+
+    if (nearby < count && boundary < first) {
+        first = boundary;
+    }
+    return first;
+}
+
+/* Lists every sleeping process with its wake tick, in no particular order.
+   Used by Scheduler::SaveCheckpoint(). */
+void TimerWheel::Collect(vector<pair<Process*, unsigned long long>>& entries) const {
+    for (int level = 0; level < LEVELS; level++) {
+        for (int index = 0; index < SLOTS; index++) {
+            for (const auto& entry : slots[level][index]) {
+                entries.push_back(make_pair(entry.proc, entry.wakeTick));
+            }
+        }
+    }
+}
+
+/* Drops every sleeper and moves the wheel to the given tick, as if it had
+   advanced there while empty. Used before restoring a checkpoint. */
+void TimerWheel::Reset(unsigned long long tick) {
+    for (int level = 0; level < LEVELS; level++) {
+        for (int index = 0; index < SLOTS; index++) {
+            slots[level][index].clear();
+        }
+    }
+    now = tick;
+    count = 0;
+}
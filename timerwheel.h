@@ -0,0 +1,46 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+using namespace std;
+
+class Process;
+
+/* Hierarchical timing wheel holding sleeping processes, keyed by wake-up tick.
+   Level 0 has one slot per tick; every higher level covers 64x the range of
+   the one below and is cascaded down when the lower level wraps around. */
+class TimerWheel {
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    struct Entry {
+        Process* proc;
+        unsigned long long wakeTick;
+    };
+
+    vector<Entry> slots[LEVELS][SLOTS];
+    unsigned long long now;
+    size_t count;
+
+    void Place(const Entry& entry);
+    void Cascade(int level);
+
+public:
+    TimerWheel();
+
+    void Schedule(Process* proc, unsigned long long wakeTick);
+    void Advance(unsigned long long tick, vector<Process*>& expired);
+    unsigned long long NextExpiry() const;
+    void Collect(vector<pair<Process*, unsigned long long>>& entries) const;
+    void Reset(unsigned long long tick);
+
+    size_t Size() const { return count; }
+    unsigned long long GetNow() const { return now; }
+};
+
+#endif
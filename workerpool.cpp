@@ -0,0 +1,92 @@
+/* Host worker threads used to execute simulated cores in parallel */
+
+#include "workerpool.h"
+
+using namespace std;
+
+/* Constructor creates an empty pool. Until Start() is called every phase
+   runs inline on the calling thread (single slot). */
+WorkerPool::WorkerPool() : numSlots(1), pending(0), phase(0), stopping(false) {}
+
+/* Destructor joins all worker threads. */
+WorkerPool::~WorkerPool() {
+    Shutdown();
+}
+
+/* Spawns slots - 1 worker threads. Slot 0 is always the calling thread,
+   so Start(1) keeps the old single-threaded behavior. */
+void WorkerPool::Start(int slots) {
+    Shutdown();
+
+    numSlots = slots < 1 ? 1 : slots;
+    stopping = false;
+
+    for (int i = 1; i < numSlots; i++) {
+        workers.emplace_back(&WorkerPool::WorkerLoop, this, i);
+    }
+}
+
+/* Signals every worker to exit and waits for them. */
+void WorkerPool::Shutdown() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    startSignal.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+    numSlots = 1;
+}
+
+/* Runs work(slot) once on every slot and returns when all of them are done.
+   This is the barrier between the parallel execute phase of a tick and the
+   serial bookkeeping phase in Scheduler::Tick(). */
+void WorkerPool::RunPhase(const function<void(int)>& work) {
+    if (numSlots == 1) {
+        work(0);
+        return;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        job = work;
+        pending = numSlots - 1;
+        phase++;
+    }
+    startSignal.notify_all();
+
+    work(0);
+
+    unique_lock<mutex> guard(lock);
+    doneSignal.wait(guard, [this] { return pending == 0; });
+    job = nullptr;
+}
+
+/* Worker body: waits for a new phase, runs its slot, reports completion. */
+void WorkerPool::WorkerLoop(int slot) {
+    unsigned long long seenPhase = 0;
+
+    while (true) {
+        function<void(int)> work;
+        {
+            unique_lock<mutex> guard(lock);
+            startSignal.wait(guard, [&] { return stopping || phase != seenPhase; });
+            if (stopping) return;
+            seenPhase = phase;
+            work = job;
+        }
+
+        work(slot);
+
+        {
+            lock_guard<mutex> guard(lock);
+            pending--;
+        }
+        doneSignal.notify_one();
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+class WorkerPool {
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable startSignal;
+    condition_variable doneSignal;
+    function<void(int)> job;
+    int numSlots;
+    int pending;
+    unsigned long long phase;
+    bool stopping;
+
+    void WorkerLoop(int slot);
+
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    void Start(int slots);
+    void Shutdown();
+    void RunPhase(const function<void(int)>& work);
+
+    int GetSlotCount() const { return numSlots; }
+};
+
+#endif